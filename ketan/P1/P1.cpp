@@ -1,4 +1,5 @@
 #include <bits/stdc++.h>
+#include <sys/resource.h>
 using namespace std;
 
 // ---------------- Edge Structure ---------------- //
@@ -19,10 +20,13 @@ public:
             parent[i] = i;
     }
 
+    // Iterative path halving: no recursion depth on long chains
     int findSet(int v) {
-        if (v == parent[v])
-            return v;
-        return parent[v] = findSet(parent[v]);
+        while (v != parent[v]) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
     }
 
     bool unionSet(int a, int b) {
@@ -37,14 +41,176 @@ public:
     }
 };
 
+// ---------------- Concurrent Disjoint Set Union ---------------- //
+// Lock-free DSU safe to call from many threads at once. Each node is one
+// 64-bit word (rank << 32 | parent) so a link only succeeds while the
+// child is still a root with the rank that was compared; roots are linked
+// in (rank, index) order, which keeps every parent chain acyclic.
+// findSet never blocks: it path-halves with a CAS that may simply fail.
+class ConcurrentDSU {
+    vector<atomic<uint64_t>> node;
+
+    static int parentOf(uint64_t w) { return (int)(uint32_t)w; }
+    static uint32_t rankOf(uint64_t w) { return (uint32_t)(w >> 32); }
+    static uint64_t pack(uint32_t r, int p) { return (uint64_t)r << 32 | (uint32_t)p; }
+
+public:
+    ConcurrentDSU(int n = 0) : node(n) {
+        for (int i = 0; i < n; i++) node[i].store(pack(0, i), memory_order_relaxed);
+    }
+
+    int findSet(int v) {
+        while (true) {
+            uint64_t w = node[v].load(memory_order_acquire);
+            int p = parentOf(w);
+            if (p == v) return v;
+
+            int gp = parentOf(node[p].load(memory_order_acquire));
+            if (gp != p)
+                node[v].compare_exchange_weak(w, pack(rankOf(w), gp),
+                                              memory_order_acq_rel);
+            v = gp;
+        }
+    }
+
+    bool sameSet(int a, int b) {
+        while (true) {
+            a = findSet(a);
+            b = findSet(b);
+            if (a == b) return true;
+            // a still a root means the two really were apart at this instant
+            if (parentOf(node[a].load(memory_order_acquire)) == a) return false;
+        }
+    }
+
+    bool unionSet(int a, int b) {
+        while (true) {
+            a = findSet(a);
+            b = findSet(b);
+            if (a == b) return false;
+
+            uint64_t wa = node[a].load(memory_order_acquire);
+            uint64_t wb = node[b].load(memory_order_acquire);
+            if (parentOf(wa) != a || parentOf(wb) != b) continue;
+
+            uint32_t ra = rankOf(wa), rb = rankOf(wb);
+            if (ra < rb || (ra == rb && a < b)) {
+                swap(a, b);
+                swap(wa, wb);
+                swap(ra, rb);
+            }
+
+            // link b under a
+            if (!node[b].compare_exchange_strong(wb, pack(rb, a), memory_order_acq_rel))
+                continue;
+            if (ra == rb)
+                node[a].compare_exchange_strong(wa, pack(ra + 1, a), memory_order_acq_rel);
+            return true;
+        }
+    }
+};
+
 // ---------------- MST Result ---------------- //
 struct MSTResult {
     int totalCost = 0;
     vector<Edge> edges;
 };
 
+// ---------------- Single-Linkage Dendrogram ---------------- //
+// Records the order in which Kruskal joins components. Leaves are the
+// vertices 0..V-1 and merge i creates cluster V + i, so one Kruskal pass
+// answers any "k clusters" or "cut at weight w" query in O(V α(V)).
+struct Merge {
+    int a, b;   // clusters joined
+    int w;      // edge weight that joined them
+    int size;   // vertices in the new cluster
+};
+
+class Dendrogram {
+    vector<int> rootCluster, clusterSize; // build state, indexed by DSU root / cluster
+
+    vector<int> replay(size_t count) const {
+        // rep[c] = some leaf inside cluster c
+        vector<int> rep(V + count);
+        for (int v = 0; v < V; v++) rep[v] = v;
+
+        DSU dsu(V);
+        for (size_t i = 0; i < count; i++) {
+            rep[V + i] = rep[merges[i].a];
+            dsu.unionSet(rep[merges[i].a], rep[merges[i].b]);
+        }
+
+        vector<int> label(V), id(V, -1);
+        int next = 0;
+        for (int v = 0; v < V; v++) {
+            int r = dsu.findSet(v);
+            if (id[r] == -1) id[r] = next++;
+            label[v] = id[r];
+        }
+        return label;
+    }
+
+public:
+    int V = 0;
+    vector<Merge> merges;
+
+    void begin(int n) {
+        V = n;
+        merges.clear();
+        rootCluster.resize(n);
+        for (int i = 0; i < n; i++) rootCluster[i] = i;
+        clusterSize.assign(n, 1);
+    }
+
+    // rootA and rootB were DSU roots before the union, newRoot is the root after.
+    void join(int rootA, int rootB, int newRoot, int w) {
+        int a = rootCluster[rootA], b = rootCluster[rootB];
+        int size = clusterSize[a] + clusterSize[b];
+        merges.push_back({a, b, w, size});
+        rootCluster[newRoot] = V + (int)merges.size() - 1;
+        clusterSize.push_back(size);
+    }
+
+    // Cluster label (0..k-1) per vertex. A disconnected graph cannot go below
+    // its component count.
+    vector<int> clustersAtCount(int k) const {
+        size_t count = k >= V ? 0 : min(merges.size(), (size_t)(V - max(k, 1)));
+        return replay(count);
+    }
+
+    // Cluster label per vertex when only edges of weight <= w are joined.
+    vector<int> clustersAtThreshold(int w) const {
+        size_t count = 0;
+        while (count < merges.size() && merges[count].w <= w) count++;
+        return replay(count);
+    }
+
+    bool writeCSV(const string &file) const {
+        ofstream out(file);
+        if (!out.is_open()) return false;
+        out << "cluster_a,cluster_b,w,size\n";
+        for (auto &m : merges)
+            out << m.a << "," << m.b << "," << m.w << "," << m.size << "\n";
+        return true;
+    }
+
+    // Binary layout: int32 V, int32 merge count, then 4 x int32 per merge.
+    bool writeBinary(const string &file) const {
+        ofstream out(file, ios::binary);
+        if (!out.is_open()) return false;
+        int32_t header[2] = {V, (int32_t)merges.size()};
+        out.write((const char *)header, sizeof(header));
+        for (auto &m : merges) {
+            int32_t row[4] = {m.a, m.b, m.w, m.size};
+            out.write((const char *)row, sizeof(row));
+        }
+        return true;
+    }
+};
+
 // ---------------- Kruskal Algorithm ---------------- //
-MSTResult kruskalMST(int V, vector<Edge> edges) {
+// Pass a Dendrogram to also record the single-linkage merge order.
+MSTResult kruskalMST(int V, vector<Edge> edges, Dendrogram *dendro = nullptr) {
     MSTResult res;
 
     sort(edges.begin(), edges.end(),
@@ -53,9 +219,12 @@ MSTResult kruskalMST(int V, vector<Edge> edges) {
          });
 
     DSU dsu(V);
+    if (dendro) dendro->begin(V);
 
     for (auto &e : edges) {
-        if (dsu.unionSet(e.u, e.v)) {
+        int ru = dsu.findSet(e.u), rv = dsu.findSet(e.v);
+        if (dsu.unionSet(ru, rv)) {
+            if (dendro) dendro->join(ru, rv, dsu.findSet(ru), e.w);
             res.edges.push_back(e);
             res.totalCost += e.w;
             if ((int)res.edges.size() == V - 1)
@@ -65,6 +234,510 @@ MSTResult kruskalMST(int V, vector<Edge> edges) {
     return res;
 }
 
+// ---------------- Radix-Sorted Kruskal (integer weights) ---------------- //
+// Returns edge indices in non-decreasing weight order without copying the
+// edges. Narrow weight ranges take one counting-sort pass; wider ones fall
+// back to LSD radix sort on 11-bit digits of (w - minW), with the key packed
+// above the index in one 64-bit word so each pass moves a single array.
+vector<uint32_t> radixOrderByWeight(const vector<Edge> &edges) {
+    size_t E = edges.size();
+    if (E == 0) return {};
+
+    int minW = INT_MAX, maxW = INT_MIN;
+    for (auto &e : edges) {
+        minW = min(minW, e.w);
+        maxW = max(maxW, e.w);
+    }
+    uint32_t range = (uint32_t)((long long)maxW - minW);
+    auto keyOf = [&](const Edge &e) { return (uint32_t)((long long)e.w - minW); };
+
+    if (range < (1u << 16)) {
+        vector<uint32_t> order(E);
+        vector<size_t> count(range + 2, 0);
+        for (auto &e : edges) count[keyOf(e) + 1]++;
+        for (size_t k = 1; k < count.size(); k++) count[k] += count[k - 1];
+        for (size_t i = 0; i < E; i++) order[count[keyOf(edges[i])]++] = i;
+        return order;
+    }
+
+    const int BITS = 11;
+    const uint32_t MASK = (1u << BITS) - 1;
+    vector<uint64_t> packed(E), tmp(E);
+    for (size_t i = 0; i < E; i++) packed[i] = (uint64_t)keyOf(edges[i]) << 32 | i;
+
+    for (int shift = 32; shift < 64 && (range >> (shift - 32)); shift += BITS) {
+        vector<size_t> count(MASK + 2, 0);
+        for (uint64_t x : packed) count[((x >> shift) & MASK) + 1]++;
+        for (size_t k = 1; k < count.size(); k++) count[k] += count[k - 1];
+        for (uint64_t x : packed) tmp[count[(x >> shift) & MASK]++] = x;
+        swap(packed, tmp);
+    }
+    vector<uint64_t>().swap(tmp);
+
+    vector<uint32_t> order(E);
+    for (size_t i = 0; i < E; i++) order[i] = (uint32_t)packed[i];
+    return order;
+}
+
+MSTResult kruskalRadixMST(int V, const vector<Edge> &edges, Dendrogram *dendro = nullptr) {
+    MSTResult res;
+    vector<uint32_t> order = radixOrderByWeight(edges);
+
+    DSU dsu(V);
+    if (dendro) dendro->begin(V);
+
+    for (uint32_t idx : order) {
+        const Edge &e = edges[idx];
+        int ru = dsu.findSet(e.u), rv = dsu.findSet(e.v);
+        if (dsu.unionSet(ru, rv)) {
+            if (dendro) dendro->join(ru, rv, dsu.findSet(ru), e.w);
+            res.edges.push_back(e);
+            res.totalCost += e.w;
+            if ((int)res.edges.size() == V - 1)
+                break;
+        }
+    }
+    return res;
+}
+
+// ---------------- Parallel Helper ---------------- //
+// Splits [0, n) into one contiguous chunk per thread and runs f(lo, hi, t).
+// With a single thread the chunks run inline on the caller.
+template <class F>
+void parallelChunks(size_t n, int threads, F f) {
+    size_t step = (n + threads - 1) / threads;
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        size_t lo = min(n, t * step), hi = min(n, lo + step);
+        if (threads == 1) f(lo, hi, t);
+        else pool.emplace_back(f, lo, hi, t);
+    }
+    for (auto &th : pool) th.join();
+}
+
+// ---------------- Parallel Edge-Batch Union ---------------- //
+// Unions every edge of the batch across threads; returns how many merged.
+size_t parallelUnionEdges(ConcurrentDSU &dsu, const vector<Edge> &edges, int threads) {
+    vector<size_t> merged(threads, 0);
+    parallelChunks(edges.size(), threads, [&](size_t lo, size_t hi, int t) {
+        for (size_t i = lo; i < hi; i++)
+            if (dsu.unionSet(edges[i].u, edges[i].v)) merged[t]++;
+    });
+    return accumulate(merged.begin(), merged.end(), size_t(0));
+}
+
+// ---------------- Connected Component Labelling ---------------- //
+// label[v] = representative vertex of v's component.
+vector<int> componentLabels(int V, const vector<Edge> &edges, int threads) {
+    ConcurrentDSU dsu(V);
+    parallelUnionEdges(dsu, edges, threads);
+
+    vector<int> label(V);
+    parallelChunks(V, threads, [&](size_t lo, size_t hi, int) {
+        for (size_t v = lo; v < hi; v++) label[v] = dsu.findSet(v);
+    });
+    return label;
+}
+
+// ---------------- Parallel Boruvka Algorithm ---------------- //
+// Each round every component picks its lightest outgoing edge in parallel
+// (atomic min over a packed weight/index key, so ties break by edge index
+// and no cycle can form), the picks are merged, and the surviving
+// inter-component edges are compacted for the next round.
+MSTResult parallelBoruvkaMST(int V, const vector<Edge> &edges, int threads) {
+    MSTResult res;
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+
+    const uint64_t NONE = UINT64_MAX;
+    vector<atomic<uint64_t>> best(V);
+    vector<int> comp(V);
+    for (int i = 0; i < V; i++) comp[i] = i;
+
+    vector<uint32_t> live(edges.size()), next(edges.size());
+    for (size_t i = 0; i < edges.size(); i++) live[i] = i;
+
+    ConcurrentDSU dsu(V);
+    vector<size_t> counts(threads);
+    vector<MSTResult> picked(threads);
+
+    while (!live.empty()) {
+        for (int i = 0; i < V; i++) best[i].store(NONE, memory_order_relaxed);
+
+        // Step 1: lightest edge leaving each component
+        parallelChunks(live.size(), threads, [&](size_t lo, size_t hi, int) {
+            for (size_t i = lo; i < hi; i++) {
+                const Edge &e = edges[live[i]];
+                int cu = comp[e.u], cv = comp[e.v];
+                if (cu == cv) continue;
+
+                uint64_t key = (uint64_t)((uint32_t)e.w ^ 0x80000000u) << 32 | live[i];
+                for (int c : {cu, cv}) {
+                    uint64_t cur = best[c].load(memory_order_relaxed);
+                    while (key < cur &&
+                           !best[c].compare_exchange_weak(cur, key, memory_order_relaxed));
+                }
+            }
+        });
+
+        // Step 2: contract along the chosen edges (an edge picked by both
+        // of its components only merges once)
+        parallelChunks(V, threads, [&](size_t lo, size_t hi, int t) {
+            for (size_t c = lo; c < hi; c++) {
+                uint64_t key = best[c].load(memory_order_relaxed);
+                if (key == NONE) continue;
+                const Edge &e = edges[(uint32_t)key];
+                if (dsu.unionSet(e.u, e.v)) {
+                    picked[t].edges.push_back(e);
+                    picked[t].totalCost += e.w;
+                }
+            }
+        });
+
+        bool merged = false;
+        for (auto &p : picked) {
+            merged |= !p.edges.empty();
+            res.edges.insert(res.edges.end(), p.edges.begin(), p.edges.end());
+            res.totalCost += p.totalCost;
+            p = MSTResult();
+        }
+        if (!merged) break;
+
+        parallelChunks(V, threads, [&](size_t lo, size_t hi, int) {
+            for (size_t i = lo; i < hi; i++) comp[i] = dsu.findSet(i);
+        });
+
+        // Step 3: drop edges that became internal to a component
+        parallelChunks(live.size(), threads, [&](size_t lo, size_t hi, int t) {
+            size_t k = 0;
+            for (size_t i = lo; i < hi; i++) {
+                const Edge &e = edges[live[i]];
+                if (comp[e.u] != comp[e.v]) live[lo + k++] = live[i];
+            }
+            counts[t] = k;
+        });
+
+        size_t step = (live.size() + threads - 1) / threads, total = 0;
+        for (int t = 0; t < threads; t++) {
+            size_t lo = min(live.size(), t * step);
+            copy(live.begin() + lo, live.begin() + lo + counts[t], next.begin() + total);
+            total += counts[t];
+        }
+        next.resize(total);
+        swap(live, next);
+    }
+    return res;
+}
+
+// ---------------- Link-Cut Tree (path maximum) ---------------- //
+// Nodes are 1-based (0 is the null node). Each node carries a value and
+// every splay subtree keeps the index of its maximum-value node.
+class LinkCutTree {
+    vector<array<int,2>> ch;
+    vector<int> par, val, mx;
+    vector<char> rev;
+    vector<int> pending; // splay push-down scratch
+
+    bool notRoot(int x) {
+        int p = par[x];
+        return p && (ch[p][0] == x || ch[p][1] == x);
+    }
+
+    void pull(int x) {
+        mx[x] = x;
+        for (int c : ch[x])
+            if (c && val[mx[c]] > val[mx[x]]) mx[x] = mx[c];
+    }
+
+    void push(int x) {
+        if (!rev[x]) return;
+        swap(ch[x][0], ch[x][1]);
+        for (int c : ch[x])
+            if (c) rev[c] ^= 1;
+        rev[x] = 0;
+    }
+
+    void rotate(int x) {
+        int y = par[x], z = par[y];
+        int dx = ch[y][1] == x;
+        if (notRoot(y)) ch[z][ch[z][1] == y] = x;
+        par[x] = z;
+        ch[y][dx] = ch[x][!dx];
+        if (ch[x][!dx]) par[ch[x][!dx]] = y;
+        ch[x][!dx] = y;
+        par[y] = x;
+        pull(y);
+        pull(x);
+    }
+
+    void splay(int x) {
+        pending.clear();
+        for (int y = x;; y = par[y]) {
+            pending.push_back(y);
+            if (!notRoot(y)) break;
+        }
+        for (int i = (int)pending.size() - 1; i >= 0; i--) push(pending[i]);
+
+        while (notRoot(x)) {
+            int y = par[x], z = par[y];
+            if (notRoot(y))
+                rotate((ch[y][0] == x) != (ch[z][0] == y) ? x : y);
+            rotate(x);
+        }
+    }
+
+    void access(int x) {
+        for (int last = 0; x; last = x, x = par[x]) {
+            splay(x);
+            ch[x][1] = last;
+            pull(x);
+        }
+    }
+
+    void makeRoot(int x) {
+        access(x);
+        splay(x);
+        rev[x] ^= 1;
+    }
+
+public:
+    void resize(int n) {
+        int old = par.size();
+        ch.resize(n + 1, {0, 0});
+        par.resize(n + 1, 0);
+        val.resize(n + 1, INT_MIN);
+        mx.resize(n + 1);
+        rev.resize(n + 1, 0);
+        for (int i = old; i <= n; i++) mx[i] = i;
+    }
+
+    void setValue(int x, int w) {
+        access(x);
+        splay(x);
+        val[x] = w;
+        pull(x);
+    }
+
+    int findRoot(int x) {
+        access(x);
+        splay(x);
+        push(x);
+        while (ch[x][0]) {
+            x = ch[x][0];
+            push(x);
+        }
+        splay(x);
+        return x;
+    }
+
+    bool connected(int x, int y) { return findRoot(x) == findRoot(y); }
+
+    void link(int x, int y) {
+        makeRoot(x);
+        par[x] = y;
+    }
+
+    void cut(int x, int y) {
+        makeRoot(x);
+        access(y);
+        splay(y);
+        ch[y][0] = 0;
+        par[x] = 0;
+        pull(y);
+    }
+
+    int pathMax(int x, int y) {
+        makeRoot(x);
+        access(y);
+        splay(y);
+        return mx[y];
+    }
+};
+
+// ---------------- Dynamic MST ---------------- //
+// Maintains a minimum spanning forest under edge insertion, deletion and
+// re-weighting. Tree edges live in a link-cut tree as their own nodes so a
+// path-maximum query finds the edge to swap out on insert / decrease in
+// O(log V). Deleting (or raising) a tree edge grows both halves of the cut
+// in lock step over the tree edges until one runs out; that smaller half is
+// the only one searched. Every crossing edge has an endpoint there, and each
+// vertex keeps its non-tree edges in weight order, so the search stops at
+// the first crossing edge per vertex and at the best weight found so far.
+class DynamicMST {
+    int V;
+    vector<Edge> edges;
+    vector<char> alive, inTree;
+    vector<set<pair<int,int>>> nonTreeAt; // per vertex: (w, id)
+    vector<vector<int>> treeAdj;          // per vertex: tree edge ids
+    vector<int> mark;                     // cut-side stamps for reconnect
+    int stamp = 0;
+    LinkCutTree lct;
+
+    int vnode(int v) const { return v + 1; }
+    int enode(int id) const { return V + 1 + id; }
+    int other(int id, int x) const { return edges[id].u == x ? edges[id].v : edges[id].u; }
+
+    void addNonTree(int id) {
+        nonTreeAt[edges[id].u].insert({edges[id].w, id});
+        nonTreeAt[edges[id].v].insert({edges[id].w, id});
+    }
+
+    void removeNonTree(int id) {
+        nonTreeAt[edges[id].u].erase({edges[id].w, id});
+        nonTreeAt[edges[id].v].erase({edges[id].w, id});
+    }
+
+    void linkEdge(int id) {
+        const Edge &e = edges[id];
+        lct.setValue(enode(id), e.w);
+        lct.link(vnode(e.u), enode(id));
+        lct.link(enode(id), vnode(e.v));
+        treeAdj[e.u].push_back(id);
+        treeAdj[e.v].push_back(id);
+        inTree[id] = 1;
+        totalCost += e.w;
+    }
+
+    void cutEdge(int id) {
+        const Edge &e = edges[id];
+        lct.cut(vnode(e.u), enode(id));
+        lct.cut(enode(id), vnode(e.v));
+        for (int x : {e.u, e.v}) {
+            auto &adj = treeAdj[x];
+            *find(adj.begin(), adj.end(), id) = adj.back();
+            adj.pop_back();
+        }
+        inTree[id] = 0;
+        totalCost -= e.w;
+    }
+
+    // Place a live non-tree edge: link it directly, swap it for the heaviest
+    // edge on the tree path it closes, or keep it as a non-tree edge.
+    void placeEdge(int id) {
+        const Edge &e = edges[id];
+        if (e.u != e.v && !lct.connected(vnode(e.u), vnode(e.v))) {
+            linkEdge(id);
+            return;
+        }
+        if (e.u != e.v) {
+            int heaviest = lct.pathMax(vnode(e.u), vnode(e.v)) - V - 1;
+            if (edges[heaviest].w > e.w) {
+                cutEdge(heaviest);
+                addNonTree(heaviest);
+                linkEdge(id);
+                return;
+            }
+        }
+        addNonTree(id);
+    }
+
+    // After the tree edge a-b is cut, reconnect with the lightest crossing
+    // edge. Both sides advance one tree-adjacency entry per step, so finding
+    // the smaller side costs O(its vertices + tree edges) even next to a hub.
+    void reconnect(int a, int b) {
+        stamp += 2;
+        vector<int> side[2] = {{a}, {b}};
+        size_t head[2] = {0, 0}, pos[2] = {0, 0};
+        mark[a] = stamp;
+        mark[b] = stamp + 1;
+        int small = -1;
+        while (small < 0) {
+            for (int s = 0; s < 2; s++) {
+                if (head[s] == side[s].size()) {
+                    small = s;
+                    break;
+                }
+                int x = side[s][head[s]];
+                if (pos[s] == treeAdj[x].size()) {
+                    head[s]++;
+                    pos[s] = 0;
+                    continue;
+                }
+                int y = other(treeAdj[x][pos[s]++], x);
+                if (mark[y] != stamp + s) {
+                    mark[y] = stamp + s;
+                    side[s].push_back(y);
+                }
+            }
+        }
+
+        pair<int,int> best = {INT_MAX, -1};
+        for (int x : side[small])
+            for (auto &cand : nonTreeAt[x]) {
+                if (cand >= best) break;
+                if (mark[other(cand.second, x)] != stamp + small) {
+                    best = cand;
+                    break;
+                }
+            }
+        if (best.second < 0) return;
+        removeNonTree(best.second);
+        linkEdge(best.second);
+    }
+
+public:
+    int totalCost = 0;
+
+    DynamicMST(int V, const vector<Edge> &initial)
+        : V(V), nonTreeAt(V), treeAdj(V), mark(V, 0) {
+        lct.resize(V);
+        for (auto &e : initial) insertEdge(e);
+    }
+
+    int size() const { return edges.size(); }
+    const Edge &edge(int id) const { return edges[id]; }
+    bool isAlive(int id) const { return alive[id]; }
+
+    int insertEdge(const Edge &e) {
+        int id = edges.size();
+        edges.push_back(e);
+        alive.push_back(1);
+        inTree.push_back(0);
+        lct.resize(V + (int)edges.size());
+        placeEdge(id);
+        return id;
+    }
+
+    void deleteEdge(int id) {
+        if (!alive[id]) return;
+        alive[id] = 0;
+        if (inTree[id]) {
+            cutEdge(id);
+            reconnect(edges[id].u, edges[id].v);
+        } else {
+            removeNonTree(id);
+        }
+    }
+
+    void updateWeight(int id, int w) {
+        if (!alive[id]) return;
+        Edge &e = edges[id];
+        if (inTree[id]) {
+            if (w <= e.w) {
+                totalCost += w - e.w;
+                e.w = w;
+                lct.setValue(enode(id), w);
+                return;
+            }
+            cutEdge(id);
+            e.w = w;
+            addNonTree(id);
+            reconnect(e.u, e.v);
+        } else {
+            removeNonTree(id);
+            e.w = w;
+            placeEdge(id);
+        }
+    }
+
+    MSTResult result() const {
+        MSTResult res;
+        res.totalCost = totalCost;
+        for (int id = 0; id < (int)edges.size(); id++)
+            if (alive[id] && inTree[id]) res.edges.push_back(edges[id]);
+        return res;
+    }
+};
+
 // ---------------- Prim Algorithm ---------------- //
 MSTResult primMST(int V, const vector<vector<pair<int,int>>> &adj) {
     MSTResult res;
@@ -102,8 +775,188 @@ MSTResult primMST(int V, const vector<vector<pair<int,int>>> &adj) {
     return res;
 }
 
+// ---------------- External-Memory Kruskal ---------------- //
+// Semi-external MST for edge files larger than RAM. Pass 1 streams the CSV
+// and writes sorted binary runs of at most runEdges edges to temp files;
+// pass 2 k-way merges the runs in weight order straight into the DSU.
+// Only the DSU, the MST edges and one small buffer per run stay in memory.
+struct ExternalMSTStats {
+    int V = 0;
+    size_t edgesRead = 0;
+    int runs = 0;
+};
+
+class RunReader {
+    ifstream in;
+    vector<Edge> buf;
+    size_t pos = 0, len = 0;
+public:
+    RunReader(const string &file) : in(file, ios::binary), buf(4096) {}
+
+    bool next(Edge &e) {
+        if (pos == len) {
+            in.read((char *)buf.data(), buf.size() * sizeof(Edge));
+            len = in.gcount() / sizeof(Edge);
+            pos = 0;
+            if (len == 0) return false;
+        }
+        e = buf[pos++];
+        return true;
+    }
+};
+
+MSTResult externalKruskalMST(const string &file, size_t runEdges, ExternalMSTStats &stats) {
+    MSTResult res;
+    ifstream fin(file);
+    if (!fin.is_open()) return res;
+
+    auto tmpDir = filesystem::temp_directory_path();
+    string prefix = "P1_run_" + to_string(random_device{}()) + "_";
+    vector<string> runFiles;
+
+    auto byWeight = [](const Edge &a, const Edge &b) { return a.w < b.w; };
+
+    // Pass 1: sorted runs
+    vector<Edge> chunk;
+    chunk.reserve(runEdges);
+    auto flush = [&]() {
+        if (chunk.empty()) return;
+        sort(chunk.begin(), chunk.end(), byWeight);
+        string name = (tmpDir / (prefix + to_string(runFiles.size()))).string();
+        ofstream out(name, ios::binary);
+        out.write((const char *)chunk.data(), chunk.size() * sizeof(Edge));
+        runFiles.push_back(name);
+        chunk.clear();
+    };
+
+    string line;
+    int maxNode = -1;
+    getline(fin, line); // header
+    while (getline(fin, line)) {
+        Edge e;
+        if (sscanf(line.c_str(), "%d,%d,%d", &e.u, &e.v, &e.w) != 3) continue;
+        maxNode = max(maxNode, max(e.u, e.v));
+        stats.edgesRead++;
+        chunk.push_back(e);
+        if (chunk.size() == runEdges) flush();
+    }
+    flush();
+    vector<Edge>().swap(chunk);
+
+    stats.V = maxNode + 1;
+    stats.runs = runFiles.size();
+
+    // Pass 2: k-way merge into Kruskal
+    vector<unique_ptr<RunReader>> readers;
+    vector<Edge> head(runFiles.size());
+    priority_queue<pair<int,int>, vector<pair<int,int>>, greater<pair<int,int>>> pq;
+
+    for (size_t r = 0; r < runFiles.size(); r++) {
+        readers.push_back(make_unique<RunReader>(runFiles[r]));
+        if (readers[r]->next(head[r])) pq.push({head[r].w, (int)r});
+    }
+
+    DSU dsu(stats.V);
+    while (!pq.empty() && (int)res.edges.size() < stats.V - 1) {
+        int r = pq.top().second;
+        pq.pop();
+
+        Edge e = head[r];
+        if (dsu.unionSet(e.u, e.v)) {
+            res.edges.push_back(e);
+            res.totalCost += e.w;
+        }
+        if (readers[r]->next(head[r])) pq.push({head[r].w, r});
+    }
+
+    readers.clear();
+    for (auto &f : runFiles) filesystem::remove(f);
+    return res;
+}
+
+// Peak resident set size of this process in KB (Linux reports ru_maxrss in KB).
+long peakRSSKB() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// ---------------- DSU Microbenchmark ---------------- //
+// n random unions over n vertices: sequential DSU vs ConcurrentDSU.
+void runDSUBenchmark(int n, int threads) {
+    mt19937 rng(12345);
+    vector<Edge> pairs(n);
+    for (auto &e : pairs) {
+        e.u = rng() % n;
+        e.v = rng() % n;
+        e.w = 0;
+    }
+
+    auto timeIt = [](auto &&f) {
+        auto start = chrono::steady_clock::now();
+        size_t merged = f();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return make_pair(merged, ms);
+    };
+
+    cout << "DSU benchmark: " << n << " random unions over " << n << " vertices\n\n";
+    cout << left << setw(28) << "Variant" << setw(12) << "Merges" << "Time (ms)\n";
+    cout << string(50, '-') << "\n";
+
+    auto seq = timeIt([&] {
+        DSU dsu(n);
+        size_t merged = 0;
+        for (auto &e : pairs) merged += dsu.unionSet(e.u, e.v);
+        return merged;
+    });
+    cout << left << setw(28) << "DSU (sequential)" << setw(12) << seq.first << seq.second << "\n";
+
+    for (int t = 1; t <= threads; t *= 2) {
+        auto par = timeIt([&] {
+            ConcurrentDSU dsu(n);
+            return parallelUnionEdges(dsu, pairs, t);
+        });
+        string label = "ConcurrentDSU (" + to_string(t) + " threads)";
+        cout << left << setw(28) << label << setw(12) << par.first << par.second << "\n";
+        if (par.first != seq.first) cout << "Merge count mismatch ⚠\n";
+    }
+}
+
 // ---------------- Main Function ---------------- //
-int main() {
+// Usage: P1 [parallel [threads] | dynamic [updates.csv] | dsu-bench [n] [threads]
+//           | external [edges.csv] [runEdges] | cluster [k] [table] | cut [w] [table]]
+// cluster / cut record the Kruskal dendrogram and split the vertices into k
+// districts or at edge weight w; the merge table goes to a .csv or .bin file.
+int main(int argc, char *argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "dsu-bench") {
+        int n = argc > 2 ? max(1, atoi(argv[2])) : 10000000;
+        int threads = argc > 3 ? max(1, atoi(argv[3]))
+                               : (int)max(1u, thread::hardware_concurrency());
+        runDSUBenchmark(n, threads);
+        return 0;
+    }
+
+    if (mode == "external") {
+        string file = argc > 2 ? argv[2] : "P1_input.csv";
+        size_t runEdges = argc > 3 ? max(1L, atol(argv[3])) : 4000000;
+
+        ExternalMSTStats stats;
+        MSTResult X = externalKruskalMST(file, runEdges, stats);
+        if (stats.edgesRead == 0) {
+            cout << file << " not found or empty\n";
+            return 0;
+        }
+
+        cout << "External Kruskal MST\n";
+        cout << "Vertices: " << stats.V << "  Edges: " << stats.edgesRead
+             << "  Sorted runs: " << stats.runs << "\n";
+        cout << "Total Cost: " << X.totalCost << "  (" << X.edges.size() << " edges)\n";
+        cout << "Peak RSS: " << peakRSSKB() << " KB\n";
+        return 0;
+    }
+
     ifstream fin("P1_input.csv");
     if (!fin.is_open()) {
         cout << "P1_input.csv not found\n";
@@ -140,7 +993,10 @@ int main() {
     }
 
     // Run MST Algorithms
-    MSTResult K = kruskalMST(V, edges);
+    // Integer weights: radix-ordered Kruskal, no copy of the edge list
+    bool wantDendrogram = mode == "cluster" || mode == "cut";
+    Dendrogram dendro;
+    MSTResult K = kruskalRadixMST(V, edges, wantDendrogram ? &dendro : nullptr);
     MSTResult P = primMST(V, adj);
 
     // Output Results
@@ -160,5 +1016,106 @@ int main() {
     else
         cout << "Cost Mismatch ⚠\n";
 
+    if (mode == "parallel") {
+        int maxThreads = argc > 2 ? max(1, atoi(argv[2]))
+                                  : (int)max(1u, thread::hardware_concurrency());
+
+        cout << "\nParallel Boruvka MST (" << maxThreads << " threads)\n";
+        MSTResult B = parallelBoruvkaMST(V, edges, maxThreads);
+        cout << "Total Cost: " << B.totalCost << "\n";
+        cout << (B.totalCost == K.totalCost ? "Costs Match ✔\n" : "Cost Mismatch ⚠\n");
+
+        cout << "\nThreads  Time (ms)\n";
+        for (int t = 1; t <= maxThreads; t *= 2) {
+            auto start = chrono::steady_clock::now();
+            parallelBoruvkaMST(V, edges, t);
+            auto ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            cout << left << setw(9) << t << ms << "\n";
+        }
+    }
+
+    if (mode == "dynamic") {
+        // Updates CSV: op,u,v,w with op = add | del | set
+        string file = argc > 2 ? argv[2] : "P1_updates.csv";
+        ifstream uin(file);
+        if (!uin.is_open()) {
+            cout << file << " not found\n";
+            return 0;
+        }
+
+        DynamicMST dyn(V, edges);
+        map<pair<int,int>,int> idOf;
+        for (int id = 0; id < dyn.size(); id++) {
+            const Edge &e = dyn.edge(id);
+            idOf[{min(e.u, e.v), max(e.u, e.v)}] = id;
+        }
+
+        cout << "\nDynamic MST updates (start cost " << dyn.totalCost << ")\n";
+        getline(uin, line); // header
+        while (getline(uin, line)) {
+            stringstream ss(line);
+            string op, uStr, vStr, wStr;
+            getline(ss, op, ',');
+            getline(ss, uStr, ',');
+            getline(ss, vStr, ',');
+            getline(ss, wStr, ',');
+            if (op.empty() || uStr.empty() || vStr.empty()) continue;
+
+            int u = stoi(uStr), v = stoi(vStr);
+            int w = wStr.empty() ? 0 : stoi(wStr);
+            if (u < 0 || v < 0 || u >= V || v >= V) continue;
+            pair<int,int> key = {min(u, v), max(u, v)};
+            auto it = idOf.find(key);
+
+            if (op == "add" && it == idOf.end())
+                idOf[key] = dyn.insertEdge({u, v, w});
+            else if ((op == "add" || op == "set") && it != idOf.end())
+                dyn.updateWeight(it->second, w);
+            else if (op == "del" && it != idOf.end()) {
+                dyn.deleteEdge(it->second);
+                idOf.erase(it);
+            } else
+                continue;
+
+            cout << op << " " << u << " -- " << v;
+            if (op != "del") cout << " (" << w << ")";
+            cout << "  -> Total Cost: " << dyn.totalCost << "\n";
+        }
+
+        vector<Edge> current;
+        for (int id = 0; id < dyn.size(); id++)
+            if (dyn.isAlive(id)) current.push_back(dyn.edge(id));
+        MSTResult check = kruskalMST(V, current);
+        cout << "Recomputed Kruskal Cost: " << check.totalCost << "\n";
+        cout << (check.totalCost == dyn.totalCost ? "Costs Match ✔\n" : "Cost Mismatch ⚠\n");
+    }
+
+    if (wantDendrogram) {
+        int param = argc > 2 ? atoi(argv[2]) : (mode == "cluster" ? 2 : 0);
+        vector<int> label = mode == "cluster" ? dendro.clustersAtCount(param)
+                                              : dendro.clustersAtThreshold(param);
+        int clusters = label.empty() ? 0 : *max_element(label.begin(), label.end()) + 1;
+
+        cout << "\nSingle-Linkage Districts ("
+             << (mode == "cluster" ? "k = " : "cut at w = ") << param << ")\n";
+        cout << "Clusters: " << clusters << "\n";
+        // bucket vertices by label in one pass (counting sort), then print
+        vector<int> start(clusters + 1, 0), members(V);
+        for (int v = 0; v < V; v++) start[label[v] + 1]++;
+        for (int c = 0; c < clusters; c++) start[c + 1] += start[c];
+        vector<int> fill(start.begin(), start.end() - 1);
+        for (int v = 0; v < V; v++) members[fill[label[v]]++] = v;
+        for (int c = 0; c < clusters; c++) {
+            cout << "District " << c << ":";
+            for (int i = start[c]; i < start[c + 1]; i++) cout << " " << members[i];
+            cout << "\n";
+        }
+
+        string table = argc > 3 ? argv[3] : "P1_dendrogram.csv";
+        bool binary = table.size() >= 4 && table.substr(table.size() - 4) == ".bin";
+        bool ok = binary ? dendro.writeBinary(table) : dendro.writeCSV(table);
+        cout << (ok ? "Merge table written to " : "Could not write ") << table << "\n";
+    }
+
     return 0;
 }
@@ -14,107 +14,1928 @@ public:
     int n;
     vector<vector<WeightedEdge>> timeGraph;
     vector<vector<UnweightedEdge>> simpleGraph;
+    long long simpleArcs = 0; // directed entries in simpleGraph
+    int minTimeCost = INT_MAX, maxTimeCost = 0; // bounds, never shrink
+
+    // Called as f(u, v, oldTime, newTime) whenever a road's travel time
+    // changes; oldTime = -1 for a new road. Caches register here.
+    using TimeEdgeObserver = function<void(int, int, long long, long long)>;
+    vector<TimeEdgeObserver> timeEdgeObservers;
 
     CityGraph(int nodes = 0) { init(nodes); }
 
-    void init(int nodes) {
-        n = nodes;
-        timeGraph.assign(n, {});
-        simpleGraph.assign(n, {});
+    void init(int nodes) {
+        n = nodes;
+        timeGraph.assign(n, {});
+        simpleGraph.assign(n, {});
+        simpleArcs = 0;
+        minTimeCost = INT_MAX;
+        maxTimeCost = 0;
+    }
+
+    void addTimeEdge(int u, int v, int t) {
+        if (u<0 || v<0 || u>=n || v>=n) return;
+        timeGraph[u].push_back({v, t});
+        timeGraph[v].push_back({u, t});
+        minTimeCost = min(minTimeCost, t);
+        maxTimeCost = max(maxTimeCost, t);
+        notifyTimeEdge(u, v, -1, t);
+    }
+
+    // Changes the travel time of the road u-v in place (the first one, if
+    // there are parallel roads). Returns false if there is no such road.
+    bool updateTimeEdge(int u, int v, int t) {
+        if (u<0 || v<0 || u>=n || v>=n) return false;
+        auto it = find_if(timeGraph[u].begin(), timeGraph[u].end(),
+                          [&](const WeightedEdge &e) { return e.to == v; });
+        if (it == timeGraph[u].end()) return false;
+        int oldT = it->timeCost;
+        if (oldT == t) return true;
+        it->timeCost = t;
+        for (auto &e : timeGraph[v])
+            if (e.to == u && e.timeCost == oldT) { e.timeCost = t; break; }
+        minTimeCost = min(minTimeCost, t);
+        maxTimeCost = max(maxTimeCost, t);
+        notifyTimeEdge(u, v, oldT, t);
+        return true;
+    }
+
+    void notifyTimeEdge(int u, int v, long long oldT, long long newT) {
+        for (auto &f : timeEdgeObservers)
+            if (f) f(u, v, oldT, newT);
+    }
+
+    void addSimpleEdge(int u, int v) {
+        if (u<0 || v<0 || u>=n || v>=n) return;
+        simpleGraph[u].push_back({v});
+        simpleGraph[v].push_back({u});
+        simpleArcs += 2;
+    }
+
+    // Directed (u, v, time) entries and an FNV-1a hash over them, so files
+    // precomputed from this graph can tell when the roads have changed.
+    long long timeArcCount() const {
+        long long m = 0;
+        for (auto &adj : timeGraph) m += adj.size();
+        return m;
+    }
+
+    unsigned long long timeChecksum() const {
+        unsigned long long h = 1469598103934665603ULL;
+        auto mix = [&](long long x) {
+            for (int i = 0; i < 8; i++, x >>= 8) h = (h ^ (x & 0xff)) * 1099511628211ULL;
+        };
+        for (int u = 0; u < n; u++)
+            for (auto &e : timeGraph[u]) {
+                mix(u);
+                mix(e.to);
+                mix(e.timeCost);
+            }
+        return h;
+    }
+};
+
+// -----------------------------------------------------------
+// Dijkstra
+// -----------------------------------------------------------
+void dijkstraShortestTime(const CityGraph &g, int src,
+                          vector<long long> &dist,
+                          vector<int> &parent) {
+    dist.assign(g.n, INF);
+    parent.assign(g.n, -1);
+
+    priority_queue<pair<long long,int>,
+        vector<pair<long long,int>>,
+        greater<pair<long long,int>>> pq;
+
+    dist[src] = 0;
+    pq.push({0, src});
+
+    while (!pq.empty()) {
+        auto [curDist, u] = pq.top();
+        pq.pop();
+        if (curDist > dist[u]) continue;
+
+        for (auto &e : g.timeGraph[u]) {
+            int v = e.to;
+            long long w = e.timeCost;
+            if (dist[u] + w < dist[v]) {
+                dist[v] = dist[u] + w;
+                parent[v] = u;
+                pq.push({dist[v], v});
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------
+// Dial's algorithm (bucket queue for small integer times)
+// -----------------------------------------------------------
+// Road times are whole minutes, so every tentative distance still in the
+// queue lies in [cur, cur + maxTimeCost]. One bucket per value, used
+// circularly, replaces the binary heap: O(V + E + D) where D is the
+// largest distance, with no log factor and no heap comparisons.
+const int DIAL_MAX_TIME = 1 << 16;
+
+void dijkstraDial(const CityGraph &g, int src,
+                  vector<long long> &dist,
+                  vector<int> &parent) {
+    dist.assign(g.n, INF);
+    parent.assign(g.n, -1);
+
+    int span = g.maxTimeCost + 1;
+    vector<vector<int>> buckets(span);
+    dist[src] = 0;
+    buckets[0].push_back(src);
+    long long queued = 1;
+
+    for (long long cur = 0; queued > 0; cur++) {
+        auto &bucket = buckets[cur % span];
+        // zero-minute roads append to this same bucket while it is scanned
+        for (size_t i = 0; i < bucket.size(); i++) {
+            int u = bucket[i];
+            queued--;
+            if (dist[u] != cur) continue;
+
+            for (auto &e : g.timeGraph[u]) {
+                int v = e.to;
+                long long nd = cur + e.timeCost;
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    parent[v] = u;
+                    buckets[nd % span].push_back(v);
+                    queued++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+}
+
+// Picks Dial's buckets when all road times are small non-negative
+// integers, otherwise the binary-heap Dijkstra.
+void shortestTimeTable(const CityGraph &g, int src,
+                       vector<long long> &dist,
+                       vector<int> &parent) {
+    if (g.minTimeCost >= 0 && g.maxTimeCost <= DIAL_MAX_TIME)
+        dijkstraDial(g, src, dist, parent);
+    else
+        dijkstraShortestTime(g, src, dist, parent);
+}
+
+// -----------------------------------------------------------
+// Parallel delta-stepping
+// -----------------------------------------------------------
+// Zones sit in buckets of width delta by tentative time. The lowest
+// non-empty bucket is emptied by rounds of parallel light-road
+// (time <= delta) relaxations. Then every zone settled in that bucket
+// relaxes its heavy roads once. Distances are atomics updated by CAS-min, so
+// the result equals the sequential table. There is no coordinating thread:
+// each worker files the zones it improves into its own ring of buckets, claims
+// its share of the next frontier from that ring, and finds its lowest
+// non-empty bucket; the workers meet at a spinning barrier between phases
+// and split the concatenated frontier evenly for relaxation.
+class PhaseBarrier {
+    atomic<int> waiting{0};
+    atomic<long long> generation{0};
+    int count;
+public:
+    PhaseBarrier(int n) : count(n) {}
+
+    void wait() {
+        long long gen = generation.load(memory_order_acquire);
+        if (waiting.fetch_add(1, memory_order_acq_rel) + 1 == count) {
+            waiting.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+            return;
+        }
+        // spin briefly, then yield so oversubscribed runs still progress
+        for (int spins = 0; generation.load(memory_order_acquire) == gen; spins++)
+            if (spins > 1024) this_thread::yield();
+    }
+};
+
+void deltaSteppingShortestTime(const CityGraph &g, int src,
+                               vector<long long> &dist,
+                               vector<int> &parent,
+                               int threads, long long delta) {
+    int n = g.n;
+    threads = max(1, threads);
+    delta = max(1LL, delta);
+
+    vector<atomic<long long>> d(n);
+    for (auto &x : d) x.store(INF, memory_order_relaxed);
+    d[src].store(0);
+
+    // A zone relaxed from bucket cur lands in [cur, cur + maxTime / delta + 1],
+    // so each worker's buckets are a ring of that span.
+    size_t span = (size_t)(max(0, g.maxTimeCost) / delta) + 2;
+    vector<vector<vector<int>>> ring(threads, vector<vector<int>>(span));
+    vector<vector<int>> front(threads), settled(threads);
+    vector<long long> nextBucket(threads);
+    vector<atomic<int>> claimed(n);
+    vector<atomic<long long>> settledIn(n);
+    for (int v = 0; v < n; v++) {
+        claimed[v].store(-1, memory_order_relaxed);
+        settledIn[v].store(-1, memory_order_relaxed);
+    }
+    ring[0][0].push_back(src);
+    PhaseBarrier barrier(threads);
+
+    auto relax = [&](int u, bool heavy, vector<vector<int>> &out) {
+        long long du = d[u].load(memory_order_relaxed);
+        for (auto &e : g.timeGraph[u]) {
+            if ((e.timeCost > delta) != heavy) continue;
+            long long nd = du + e.timeCost;
+            long long old = d[e.to].load(memory_order_relaxed);
+            while (nd < old) {
+                if (d[e.to].compare_exchange_weak(old, nd, memory_order_relaxed)) {
+                    out[(nd / delta) % span].push_back(e.to);
+                    break;
+                }
+            }
+        }
+    };
+
+    // Worker t relaxes slice t of the concatenation lists[0] + lists[1] + ...
+    auto relaxSlice = [&](const vector<vector<int>> &lists, const vector<size_t> &start,
+                          int t, bool heavy) {
+        size_t total = start[threads], step = (total + threads - 1) / threads;
+        size_t lo = min(total, t * step), hi = min(total, lo + step);
+        int owner = upper_bound(start.begin(), start.end(), lo) - start.begin() - 1;
+        for (size_t i = lo; i < hi; i++) {
+            while (i >= start[owner + 1]) owner++;
+            relax(lists[owner][i - start[owner]], heavy, ring[t]);
+        }
+    };
+
+    auto prefix = [&](const vector<vector<int>> &lists, vector<size_t> &start) {
+        for (int t = 0; t < threads; t++) start[t + 1] = start[t] + lists[t].size();
+    };
+
+    auto chunk = [&](size_t size, int t) {
+        size_t step = (size + threads - 1) / threads;
+        size_t lo = min(size, t * step);
+        return make_pair(lo, min(size, lo + step));
+    };
+
+    auto worker = [&](int t) {
+        long long cur = 0;
+        int phase = 0;
+        vector<size_t> frontStart(threads + 1, 0), settledStart(threads + 1, 0);
+        while (true) {
+            // light phases until no worker has a live zone left in bucket cur
+            while (true) {
+                phase++;
+                auto &mine = ring[t][cur % span];
+                front[t].clear();
+                for (int v : mine) {
+                    if (d[v].load(memory_order_relaxed) / delta != cur) continue; // moved lower
+                    if (claimed[v].exchange(phase, memory_order_relaxed) == phase) continue;
+                    front[t].push_back(v);
+                    if (settledIn[v].exchange(cur, memory_order_relaxed) != cur)
+                        settled[t].push_back(v);
+                }
+                mine.clear();
+                barrier.wait();
+                prefix(front, frontStart);
+                if (frontStart[threads] == 0) break;
+                relaxSlice(front, frontStart, t, false);
+                barrier.wait();
+            }
+
+            // heavy roads of everything settled in this bucket
+            prefix(settled, settledStart);
+            relaxSlice(settled, settledStart, t, true);
+            barrier.wait();
+            settled[t].clear();
+
+            // lowest non-empty bucket over all workers' rings
+            nextBucket[t] = -1;
+            for (size_t k = 1; k < span; k++)
+                if (!ring[t][(cur + k) % span].empty()) {
+                    nextBucket[t] = cur + k;
+                    break;
+                }
+            barrier.wait();
+            long long next = -1;
+            for (long long b : nextBucket)
+                if (b >= 0 && (next < 0 || b < next)) next = b;
+            barrier.wait(); // nextBucket is rewritten in the next round
+            if (next < 0) return;
+            cur = next;
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &th : pool) th.join();
+
+    dist.resize(n);
+    for (int v = 0; v < n; v++) dist[v] = d[v].load(memory_order_relaxed);
+
+    // Parents from final times: any road into v from a strictly closer zone
+    // that is tight. Zones only tight over 0-minute roads from equally far
+    // zones get their parent from a BFS along those roads.
+    parent.assign(n, -1);
+    vector<char> resolved(n, 0);
+    resolved[src] = 1;
+    vector<char> unresolved(threads, 0);
+    auto pickParents = [&](int t) {
+        auto [lo, hi] = chunk(n, t);
+        for (size_t v = lo; v < hi; v++) {
+            if ((int)v == src || dist[v] == INF) continue;
+            for (auto &e : g.timeGraph[v]) {
+                if (dist[e.to] < dist[v] && dist[e.to] + e.timeCost == dist[v]) {
+                    parent[v] = e.to;
+                    resolved[v] = 1;
+                    break;
+                }
+            }
+            if (!resolved[v]) unresolved[t] = 1;
+        }
+    };
+    pool.clear();
+    for (int t = 1; t < threads; t++) pool.emplace_back(pickParents, t);
+    pickParents(0);
+    for (auto &th : pool) th.join();
+
+    bool pendingZero = count(unresolved.begin(), unresolved.end(), 1) > 0;
+    if (pendingZero) {
+        queue<int> q;
+        for (int v = 0; v < n; v++)
+            if (resolved[v]) q.push(v);
+        while (!q.empty()) {
+            int u = q.front();
+            q.pop();
+            for (auto &e : g.timeGraph[u]) {
+                if (!resolved[e.to] && e.timeCost == 0 && dist[e.to] == dist[u]) {
+                    resolved[e.to] = 1;
+                    parent[e.to] = u;
+                    q.push(e.to);
+                }
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------
+// Dijkstra with a reusable workspace (resident / batch queries)
+// -----------------------------------------------------------
+// Keeps dist, parent and the heap storage alive between queries so a
+// stream of lookups does not reallocate per request. With target >= 0
+// the search stops as soon as the target is settled.
+struct SearchWorkspace {
+    vector<long long> dist;
+    vector<int> parent;
+    vector<pair<long long,int>> heap;
+    long long settled = 0; // zones settled by the last search
+};
+
+void dijkstraShortestTime(const CityGraph &g, int src,
+                          SearchWorkspace &ws, int target = -1) {
+    ws.dist.assign(g.n, INF);
+    ws.parent.assign(g.n, -1);
+    ws.heap.clear();
+    ws.settled = 0;
+
+    auto &heap = ws.heap;
+    greater<pair<long long,int>> cmp;
+
+    ws.dist[src] = 0;
+    heap.push_back({0, src});
+
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [curDist, u] = heap.back();
+        heap.pop_back();
+        if (curDist > ws.dist[u]) continue;
+        ws.settled++;
+        if (u == target) break;
+
+        for (auto &e : g.timeGraph[u]) {
+            int v = e.to;
+            long long w = e.timeCost;
+            if (ws.dist[u] + w < ws.dist[v]) {
+                ws.dist[v] = ws.dist[u] + w;
+                ws.parent[v] = u;
+                heap.push_back({ws.dist[v], v});
+                push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------
+// Bounded isochrones (sparse-reset workspace)
+// -----------------------------------------------------------
+// Scratch arrays are sized once; each search remembers the zones it wrote
+// and resets only those, so a small isochrone costs O(reached log reached)
+// instead of O(V). `settled` lists zones in non-decreasing time, so every
+// smaller budget is a prefix of the largest one.
+struct SparseWorkspace {
+    vector<long long> dist;
+    vector<int> parent;
+    vector<int> touched, settled;
+    vector<pair<long long,int>> heap;
+
+    void reset(int n) {
+        if ((int)dist.size() != n) {
+            dist.assign(n, INF);
+            parent.assign(n, -1);
+            touched.clear();
+        }
+        for (int v : touched) {
+            dist[v] = INF;
+            parent[v] = -1;
+        }
+        touched.clear();
+        settled.clear();
+        heap.clear();
+    }
+};
+
+// Settles every zone reachable from src within `budget` minutes.
+void boundedShortestTime(const CityGraph &g, int src, long long budget,
+                         SparseWorkspace &ws) {
+    ws.reset(g.n);
+    auto &heap = ws.heap;
+    greater<pair<long long,int>> cmp;
+
+    ws.dist[src] = 0;
+    ws.touched.push_back(src);
+    heap.push_back({0, src});
+
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [curDist, u] = heap.back();
+        heap.pop_back();
+        if (curDist > ws.dist[u]) continue;
+        if (curDist > budget) break;
+        ws.settled.push_back(u);
+
+        for (auto &e : g.timeGraph[u]) {
+            int v = e.to;
+            long long nd = curDist + e.timeCost;
+            if (nd <= budget && nd < ws.dist[v]) {
+                if (ws.dist[v] == INF) ws.touched.push_back(v);
+                ws.dist[v] = nd;
+                ws.parent[v] = u;
+                heap.push_back({nd, v});
+                push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+}
+
+// Zones within each budget (e.g. 5/10/15 min) from one search at the
+// largest budget. bands[i] holds the zones reachable within budgets[i].
+void multiIsochrone(const CityGraph &g, int src, vector<long long> budgets,
+                    SparseWorkspace &ws, vector<vector<int>> &bands) {
+    sort(budgets.begin(), budgets.end());
+    bands.assign(budgets.size(), {});
+    if (budgets.empty()) return;
+
+    boundedShortestTime(g, src, budgets.back(), ws);
+    size_t b = 0, i = 0;
+    for (; b < budgets.size(); b++) {
+        while (i < ws.settled.size() && ws.dist[ws.settled[i]] <= budgets[b]) i++;
+        bands[b].assign(ws.settled.begin(), ws.settled.begin() + i);
+    }
+}
+
+// -----------------------------------------------------------
+// BFS (unweighted)
+// -----------------------------------------------------------
+void bfsUnweighted(const CityGraph &g, int src,
+                   vector<int> &dist,
+                   vector<int> &parent) {
+    dist.assign(g.n, -1);
+    parent.assign(g.n, -1);
+
+    queue<int> q;
+    dist[src] = 0;
+    q.push(src);
+
+    while (!q.empty()) {
+        int u = q.front();
+        q.pop();
+
+        for (auto &e : g.simpleGraph[u]) {
+            int v = e.to;
+            if (dist[v] == -1) {
+                dist[v] = dist[u] + 1;
+                parent[v] = u;
+                q.push(v);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------
+// Direction-optimizing BFS (unweighted)
+// -----------------------------------------------------------
+// Top-down while the frontier is small; once the frontier's edges outweigh
+// the unexplored edges / ALPHA it switches to a bottom-up sweep where each
+// unvisited zone looks for any parent in a bitmap frontier, and returns to
+// top-down when the frontier shrinks below n / BETA. Hop counts match
+// bfsUnweighted; the parent chosen for a zone may differ.
+void bfsDirectionOptimizing(const CityGraph &g, int src,
+                            vector<int> &dist,
+                            vector<int> &parent) {
+    const long long ALPHA = 15, BETA = 18;
+    int n = g.n;
+    dist.assign(n, -1);
+    parent.assign(n, -1);
+
+    auto bitTest = [](const vector<uint64_t> &bits, int v) { return bits[v >> 6] >> (v & 63) & 1; };
+    auto bitSet = [](vector<uint64_t> &bits, int v) { bits[v >> 6] |= 1ULL << (v & 63); };
+
+    vector<int> frontier = {src}, next;
+    vector<uint64_t> front((n + 63) / 64);
+    dist[src] = 0;
+
+    long long frontierEdges = g.simpleGraph[src].size();
+    long long unexplored = g.simpleArcs - frontierEdges;
+
+    bool bottomUp = false;
+    int level = 0;
+
+    while (!frontier.empty()) {
+        if (!bottomUp && frontierEdges > unexplored / ALPHA)
+            bottomUp = true;
+        else if (bottomUp && (long long)frontier.size() < n / BETA)
+            bottomUp = false;
+
+        next.clear();
+        frontierEdges = 0;
+        if (bottomUp) {
+            fill(front.begin(), front.end(), 0);
+            for (int u : frontier) bitSet(front, u);
+            for (int v = 0; v < n; v++) {
+                if (dist[v] != -1) continue;
+                for (auto &e : g.simpleGraph[v]) {
+                    if (bitTest(front, e.to)) {
+                        dist[v] = level + 1;
+                        parent[v] = e.to;
+                        next.push_back(v);
+                        frontierEdges += g.simpleGraph[v].size();
+                        break;
+                    }
+                }
+            }
+        } else {
+            for (int u : frontier) {
+                for (auto &e : g.simpleGraph[u]) {
+                    int v = e.to;
+                    if (dist[v] == -1) {
+                        dist[v] = level + 1;
+                        parent[v] = u;
+                        next.push_back(v);
+                        frontierEdges += g.simpleGraph[v].size();
+                    }
+                }
+            }
+        }
+
+        unexplored -= frontierEdges;
+        swap(frontier, next);
+        level++;
+    }
+}
+
+// -----------------------------------------------------------
+// Synthetic cities (benchmarks)
+// -----------------------------------------------------------
+// side x side street grid with random 1..15 minute roads.
+CityGraph makeGridCity(int side, unsigned seed = 1) {
+    mt19937 rng(seed);
+    CityGraph g(side * side);
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int v = r * side + c;
+            if (c + 1 < side) {
+                int t = 1 + rng() % 15;
+                g.addTimeEdge(v, v + 1, t);
+                g.addSimpleEdge(v, v + 1);
+            }
+            if (r + 1 < side) {
+                int t = 1 + rng() % 15;
+                g.addTimeEdge(v, v + side, t);
+                g.addSimpleEdge(v, v + side);
+            }
+        }
+    }
+    return g;
+}
+
+// Preferential-attachment (scale-free) city: each new zone links to m
+// existing zones chosen proportionally to degree.
+CityGraph makeScaleFreeCity(int n, int m = 3, unsigned seed = 1) {
+    mt19937 rng(seed);
+    CityGraph g(n);
+    vector<int> ends;
+    for (int v = 1; v < n; v++) {
+        for (int k = 0; k < m; k++) {
+            int u = ends.empty() ? 0 : ends[rng() % ends.size()];
+            int t = 1 + rng() % 15;
+            g.addTimeEdge(u, v, t);
+            g.addSimpleEdge(u, v);
+            ends.push_back(u);
+            ends.push_back(v);
+        }
+    }
+    return g;
+}
+
+// Times `run` over a few sources and returns the average in milliseconds.
+template <class F>
+double averageMs(int runs, F run) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) run(i);
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / runs;
+}
+
+void runBFSBenchmark(int n) {
+    int side = max(2, (int)sqrt((double)n));
+    vector<pair<string, CityGraph>> cities;
+    cities.push_back({"grid " + to_string(side) + "x" + to_string(side), makeGridCity(side)});
+    cities.push_back({"scale-free " + to_string(n), makeScaleFreeCity(n)});
+
+    cout << left << setw(24) << "City" << setw(16) << "Top-down (ms)"
+         << setw(22) << "Direction-opt (ms)" << "Same hops\n";
+    cout << string(70, '-') << "\n";
+
+    for (auto &[label, g] : cities) {
+        const int runs = 5;
+        auto source = [&](int i) { return (int)((long long)i * g.n / runs); };
+        vector<int> d1, p1, d2, p2;
+
+        double tTop = averageMs(runs, [&](int i) { bfsUnweighted(g, source(i), d1, p1); });
+        double tDir = averageMs(runs, [&](int i) { bfsDirectionOptimizing(g, source(i), d2, p2); });
+
+        bool same = true;
+        for (int i = 0; i < runs; i++) {
+            bfsUnweighted(g, source(i), d1, p1);
+            bfsDirectionOptimizing(g, source(i), d2, p2);
+            same = same && d1 == d2;
+        }
+        cout << left << setw(24) << label << setw(16) << tTop
+             << setw(22) << tDir << (same ? "yes" : "NO") << "\n";
+    }
+}
+
+void runSSSPBenchmark(int n) {
+    int side = max(2, (int)sqrt((double)n));
+    vector<pair<string, CityGraph>> cities;
+    cities.push_back({"grid " + to_string(side) + "x" + to_string(side), makeGridCity(side)});
+    cities.push_back({"scale-free " + to_string(n), makeScaleFreeCity(n)});
+
+    cout << left << setw(24) << "City" << setw(18) << "Binary heap (ms)"
+         << setw(14) << "Dial (ms)" << setw(10) << "Speedup" << "Same times\n";
+    cout << string(76, '-') << "\n";
+
+    for (auto &[label, g] : cities) {
+        const int runs = 5;
+        auto source = [&](int i) { return (int)((long long)i * g.n / runs); };
+        vector<long long> d1, d2;
+        vector<int> p1, p2;
+
+        double tHeap = averageMs(runs, [&](int i) { dijkstraShortestTime(g, source(i), d1, p1); });
+        double tDial = averageMs(runs, [&](int i) { dijkstraDial(g, source(i), d2, p2); });
+
+        bool same = true;
+        for (int i = 0; i < runs; i++) {
+            dijkstraShortestTime(g, source(i), d1, p1);
+            dijkstraDial(g, source(i), d2, p2);
+            same = same && d1 == d2;
+        }
+        cout << left << setw(24) << label << setw(18) << tHeap << setw(14) << tDial
+             << setw(10) << (to_string(tHeap / tDial).substr(0, 4) + "x")
+             << (same ? "yes" : "NO") << "\n";
+    }
+}
+
+// One-to-all scaling report: delta-stepping at 1, 2, 4, ... threads
+// against the sequential binary-heap table.
+void runDeltaSteppingBenchmark(int n, int maxThreads, long long delta) {
+    int side = max(2, (int)sqrt((double)n));
+    vector<pair<string, CityGraph>> cities;
+    cities.push_back({"grid " + to_string(side) + "x" + to_string(side), makeGridCity(side)});
+    cities.push_back({"scale-free " + to_string(n), makeScaleFreeCity(n)});
+
+    for (auto &[label, g] : cities) {
+        const int runs = 3;
+        auto source = [&](int i) { return (int)((long long)i * g.n / runs); };
+        vector<long long> d1, d2;
+        vector<int> p1, p2;
+
+        cout << "\n" << label << " (delta = " << delta << ")\n";
+        cout << left << setw(12) << "Threads" << setw(14) << "Time (ms)"
+             << setw(10) << "Speedup" << "Same times\n";
+        cout << string(46, '-') << "\n";
+
+        double tSeq = averageMs(runs, [&](int i) { dijkstraShortestTime(g, source(i), d1, p1); });
+        cout << left << setw(12) << "sequential" << setw(14) << tSeq << setw(10) << "1.00x" << "-\n";
+
+        for (int t = 1; t <= maxThreads; t *= 2) {
+            double tPar = averageMs(runs, [&](int i) {
+                deltaSteppingShortestTime(g, source(i), d2, p2, t, delta);
+            });
+            bool same = true;
+            for (int i = 0; i < runs; i++) {
+                dijkstraShortestTime(g, source(i), d1, p1);
+                deltaSteppingShortestTime(g, source(i), d2, p2, t, delta);
+                same = same && d1 == d2;
+            }
+            cout << left << setw(12) << t << setw(14) << tPar
+                 << setw(10) << (to_string(tSeq / tPar).substr(0, 4) + "x")
+                 << (same ? "yes" : "NO") << "\n";
+        }
+    }
+}
+
+// -----------------------------------------------------------
+// Path builder
+// -----------------------------------------------------------
+vector<int> reconstructPath(int target, const vector<int> &parent) {
+    vector<int> path;
+    for (int cur = target; cur != -1; cur = parent[cur])
+        path.push_back(cur);
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+void printPath(const vector<int> &path, const vector<string> &names) {
+    for (size_t i = 0; i < path.size(); i++) {
+        cout << names[path[i]];
+        if (i + 1 != path.size()) cout << " -> ";
+    }
+    cout << "\n";
+}
+
+// Same as reconstructPath but fills a caller-owned buffer (no allocation
+// once the buffer has grown).
+void unpackPath(int target, const vector<int> &parent, vector<int> &path) {
+    path.clear();
+    for (int cur = target; cur != -1; cur = parent[cur])
+        path.push_back(cur);
+    reverse(path.begin(), path.end());
+}
+
+// -----------------------------------------------------------
+// Shortest-path tree export
+// -----------------------------------------------------------
+// Writes the whole tree once as (node, parent, dist) instead of one
+// reconstructed path per row, so output is O(V). Unreachable zones have
+// parent = dist = -1. Paths are unpacked later, on demand, from the tree.
+struct ShortestPathTree {
+    int src = -1;
+    vector<int> parent;
+    vector<long long> dist;
+
+    bool writeCSV(const string &file) const {
+        ofstream out(file);
+        if (!out.is_open()) return false;
+        string buf = "node,parent,dist\n";
+        buf.reserve(1 << 16);
+        for (size_t v = 0; v < dist.size(); v++) {
+            buf += to_string(v);
+            buf += ',';
+            buf += to_string(parent[v]);
+            buf += ',';
+            buf += to_string(dist[v] == INF ? -1 : dist[v]);
+            buf += '\n';
+            if (buf.size() > (1 << 16) - 64) {
+                out.write(buf.data(), buf.size());
+                buf.clear();
+            }
+        }
+        out.write(buf.data(), buf.size());
+        return (bool)out;
+    }
+
+    // Columnar layout: "SPT1", int32 n, int32 src, int32 parent[n], int64 dist[n].
+    bool writeBinary(const string &file) const {
+        ofstream out(file, ios::binary);
+        if (!out.is_open()) return false;
+        int32_t header[2] = {(int32_t)dist.size(), src};
+        vector<long long> d(dist);
+        for (auto &x : d)
+            if (x == INF) x = -1;
+        out.write("SPT1", 4);
+        out.write((const char *)header, sizeof(header));
+        out.write((const char *)parent.data(), parent.size() * sizeof(int));
+        out.write((const char *)d.data(), d.size() * sizeof(long long));
+        return (bool)out;
+    }
+
+    // Rejects trees written for another city (zone count differs) and any
+    // source or parent outside [-1, n), so unpacking stays in bounds.
+    bool loadBinary(const string &file, int expectedNodes) {
+        ifstream in(file, ios::binary);
+        char magic[4];
+        int32_t header[2];
+        if (!in.read(magic, 4) || string(magic, 4) != "SPT1") return false;
+        if (!in.read((char *)header, sizeof(header)) || header[0] != expectedNodes ||
+            header[1] < 0 || header[1] >= header[0])
+            return false;
+        src = header[1];
+        parent.resize(header[0]);
+        dist.resize(header[0]);
+        in.read((char *)parent.data(), parent.size() * sizeof(int));
+        in.read((char *)dist.data(), dist.size() * sizeof(long long));
+        if (!in || parent[src] != -1) return false;
+        for (int p : parent)
+            if (p < -1 || p >= header[0]) return false;
+        for (auto &x : dist)
+            if (x == -1) x = INF;
+        return true;
+    }
+
+    void pathTo(int target, vector<int> &path) const {
+        if (dist[target] == INF) path.clear();
+        else unpackPath(target, parent, path);
+    }
+};
+
+// -----------------------------------------------------------
+// Dynamic shortest-path repair (Ramalingam-Reps)
+// -----------------------------------------------------------
+// Fixes tree after the road u-v changed from oldT to newT (oldT = -1 for a
+// new road) and returns how many nodes changed. A faster road can only
+// improve nodes reachable through it, so we run Dijkstra from its ends and
+// stop where nothing improves. A slower road matters only if it is a tree
+// edge: the subtree hanging below it is reset, re-seeded from its settled
+// neighbours outside and settled again. Everything else is left alone.
+int repairShortestPathTree(const CityGraph &g, ShortestPathTree &tree,
+                           int u, int v, long long oldT, long long newT) {
+    auto &dist = tree.dist;
+    auto &parent = tree.parent;
+    priority_queue<pair<long long,int>, vector<pair<long long,int>>,
+                   greater<pair<long long,int>>> pq;
+    int touched = 0;
+
+    auto relaxFrom = [&](int a, int b) {
+        if (dist[a] != INF && dist[a] + newT < dist[b]) {
+            dist[b] = dist[a] + newT;
+            parent[b] = a;
+            pq.push({dist[b], b});
+        }
+    };
+
+    if (oldT < 0 || newT < oldT) {
+        relaxFrom(u, v);
+        relaxFrom(v, u);
+    } else {
+        // Orient so that v is the child of the tree edge.
+        if (parent[u] == v && dist[v] + oldT == dist[u]) swap(u, v);
+        else if (!(parent[v] == u && dist[u] + oldT == dist[v])) return 0;
+
+        // Children of x are neighbours whose parent is x. A queued node's
+        // parent is set to -2 so parallel roads cannot queue it twice.
+        vector<int> subtree = {v};
+        parent[v] = -2;
+        for (size_t i = 0; i < subtree.size(); i++) {
+            int x = subtree[i];
+            for (auto &e : g.timeGraph[x])
+                if (parent[e.to] == x && e.to != tree.src) {
+                    parent[e.to] = -2;
+                    subtree.push_back(e.to);
+                }
+        }
+        for (int x : subtree) {
+            dist[x] = INF;
+            parent[x] = -1;
+        }
+        for (int x : subtree) {
+            for (auto &e : g.timeGraph[x]) {
+                if (dist[e.to] != INF && dist[e.to] + e.timeCost < dist[x]) {
+                    dist[x] = dist[e.to] + e.timeCost;
+                    parent[x] = e.to;
+                }
+            }
+            if (dist[x] != INF) pq.push({dist[x], x});
+        }
+        touched = subtree.size();
+    }
+
+    while (!pq.empty()) {
+        auto [d, x] = pq.top(); pq.pop();
+        if (d != dist[x]) continue;
+        if (oldT < 0 || newT < oldT) touched++;
+        for (auto &e : g.timeGraph[x]) {
+            if (d + e.timeCost < dist[e.to]) {
+                dist[e.to] = d + e.timeCost;
+                parent[e.to] = x;
+                pq.push({dist[e.to], e.to});
+            }
+        }
+    }
+    return touched;
+}
+
+// Repairs after random updates against a fresh Dijkstra, on graphs with
+// doubled (parallel) roads; every repair must touch at most V zones.
+void runRepairCheck() {
+    mt19937 rng(5);
+    long long updates = 0, mismatches = 0, overTouched = 0, maxTouched = 0;
+
+    auto checkGraph = [&](CityGraph &g, int rounds) {
+        vector<pair<int,int>> roads;
+        for (int u = 0; u < g.n; u++)
+            for (auto &e : g.timeGraph[u])
+                if (u < e.to) roads.push_back({u, e.to});
+        ShortestPathTree tree;
+        tree.src = rng() % g.n;
+        shortestTimeTable(g, tree.src, tree.dist, tree.parent);
+        vector<long long> dist;
+        vector<int> parent;
+        for (int r = 0; r < rounds; r++) {
+            auto [u, v] = roads[rng() % roads.size()];
+            int oldT = -1;
+            for (auto &e : g.timeGraph[u])
+                if (e.to == v) { oldT = e.timeCost; break; }
+            int newT = rng() % 20;
+            g.updateTimeEdge(u, v, newT);
+            int touched = repairShortestPathTree(g, tree, u, v, oldT, newT);
+            updates++;
+            maxTouched = max<long long>(maxTouched, touched);
+            overTouched += touched > g.n;
+            dijkstraShortestTime(g, tree.src, dist, parent);
+            mismatches += dist != tree.dist;
+        }
+    };
+
+    // 40-zone chain with every road doubled, slowed road by road
+    CityGraph chain(40);
+    for (int i = 0; i + 1 < 40; i++) {
+        chain.addTimeEdge(i, i + 1, 1);
+        chain.addTimeEdge(i, i + 1, 1);
+    }
+    ShortestPathTree tree;
+    tree.src = 0;
+    shortestTimeTable(chain, 0, tree.dist, tree.parent);
+    chain.updateTimeEdge(0, 1, 5);
+    int touched = repairShortestPathTree(chain, tree, 0, 1, 1, 5);
+    updates++;
+    maxTouched = max<long long>(maxTouched, touched);
+    overTouched += touched > chain.n;
+
+    for (int it = 0; it < 200; it++) {
+        int n = 5 + rng() % 40;
+        CityGraph g(n);
+        for (int e = 0; e < 2 * n; e++) {
+            int u = rng() % n, v = rng() % n, t = rng() % 10;
+            if (u == v) continue;
+            g.addTimeEdge(u, v, t);
+            if (rng() % 2) g.addTimeEdge(u, v, t); // parallel road
+        }
+        if (g.minTimeCost != INT_MAX) checkGraph(g, 50);
+    }
+
+    cout << "Repair check: " << updates << " updates, " << mismatches << " mismatches, "
+         << overTouched << " repairs touching more than V zones (max touched "
+         << maxTouched << ")\n";
+}
+
+// -----------------------------------------------------------
+// Shortest-path-tree cache (LRU, byte budget)
+// -----------------------------------------------------------
+// Keeps whole dist/parent trees for recently used sources within a byte
+// budget, evicting the least recently used. The cache watches the graph
+// and repairs cached trees in place when a road is added or retimed, so
+// a live traffic feed never forces a full recompute.
+class ShortestPathTreeCache {
+    CityGraph &g;
+    size_t observerSlot;
+    list<ShortestPathTree> lru; // front = most recent
+    unordered_map<int, list<ShortestPathTree>::iterator> bySource;
+
+    size_t treeBytes() const {
+        return (size_t)g.n * (sizeof(long long) + sizeof(int)) + sizeof(ShortestPathTree);
+    }
+
+    void onTimeEdgeChange(int u, int v, long long oldT, long long newT) {
+        lastTouched = 0;
+        for (auto &tree : lru) {
+            int touched = repairShortestPathTree(g, tree, u, v, oldT, newT);
+            if (touched) repairs++;
+            lastTouched += touched;
+        }
+        nodesTouched += lastTouched;
+    }
+
+public:
+    size_t byteBudget, bytesUsed = 0;
+    long long hits = 0, misses = 0, evictions = 0;
+    long long repairs = 0, nodesTouched = 0, lastTouched = 0;
+
+    ShortestPathTreeCache(CityGraph &graph, size_t budget) : g(graph), byteBudget(budget) {
+        observerSlot = g.timeEdgeObservers.size();
+        g.timeEdgeObservers.push_back([this](int u, int v, long long oldT, long long newT) {
+            onTimeEdgeChange(u, v, oldT, newT);
+        });
+    }
+
+    ~ShortestPathTreeCache() { g.timeEdgeObservers[observerSlot] = nullptr; }
+
+    // The reference stays valid until the next get() or graph change.
+    const ShortestPathTree &get(int src) {
+        auto found = bySource.find(src);
+        if (found != bySource.end()) {
+            hits++;
+            lru.splice(lru.begin(), lru, found->second);
+            return lru.front();
+        }
+
+        misses++;
+        ShortestPathTree tree;
+        tree.src = src;
+        shortestTimeTable(g, src, tree.dist, tree.parent);
+
+        while (!lru.empty() && bytesUsed + treeBytes() > byteBudget) {
+            bySource.erase(lru.back().src);
+            lru.pop_back();
+            bytesUsed -= treeBytes();
+            evictions++;
+        }
+        lru.push_front(move(tree));
+        bySource[src] = lru.begin();
+        bytesUsed += treeBytes();
+        return lru.front();
+    }
+
+    size_t size() const { return lru.size(); }
+};
+
+// -----------------------------------------------------------
+// K shortest loopless routes (Yen)
+// -----------------------------------------------------------
+// Yen's algorithm, with every spur search backed by one shortest-path tree
+// grown from the target. Spur searches are A* with the tree times as the
+// heuristic: removing roads only lengthens routes, so they stay a valid
+// lower bound. Also, as soon as A* pops a zone whose tree route to the
+// target avoids every removed zone and road, that route completes an
+// optimal spur path. Most spur searches settle only a few zones, and the
+// "does the tree route stay clear" test is memoised per deviated route.
+struct Route {
+    long long time;
+    vector<int> path;
+};
+
+class AlternativeRouter {
+    const CityGraph &g;
+    int target;
+    vector<long long> toTarget;   // tree from the target (roads are two-way)
+    vector<int> towardTarget;     // next zone toward the target
+
+    vector<char> blockedZone;
+    vector<int> blockedNext;      // roads out of the spur zone to skip
+    SparseWorkspace ws;
+
+    // For the route being deviated from: posOnLast[v] = index of v on it,
+    // hitIndex[v] = first index of that route the tree route v -> target
+    // runs through (memoised once per deviated route, shared by its spurs).
+    vector<int> posOnLast, hitStamp, hitIndex, walk;
+    int stamp = 0;
+
+    bool roadBlocked(int u, int v, int spur) const {
+        return u == spur && find(blockedNext.begin(), blockedNext.end(), v) != blockedNext.end();
+    }
+
+    int firstHit(int u) {
+        walk.clear();
+        int v = u;
+        while (v != -1 && hitStamp[v] != stamp) {
+            walk.push_back(v);
+            v = towardTarget[v];
+        }
+        int hit = v == -1 ? INT_MAX : hitIndex[v];
+        for (int i = (int)walk.size() - 1; i >= 0; i--) {
+            int x = walk[i];
+            if (posOnLast[x] >= 0) hit = min(hit, posOnLast[x]);
+            hitStamp[x] = stamp;
+            hitIndex[x] = hit;
+        }
+        return hitIndex[u];
+    }
+
+    // Does the tree route u -> target avoid the root zones, the spur zone
+    // (spurIndex on the deviated route) and the removed spur roads?
+    bool treeRouteClear(int u, int spur, int spurIndex) {
+        if (u != spur) return firstHit(u) > spurIndex;
+        if (u == target) return true;
+        int next = towardTarget[u];
+        return !roadBlocked(spur, next, spur) && firstHit(next) > spurIndex;
+    }
+
+    // Fastest spur -> target route avoiding blocked zones / spur roads.
+    // Gives up (INF) once every open route would take longer than cutoff.
+    long long spurSearch(int spur, int spurIndex, long long cutoff, vector<int> &path) {
+        path.clear();
+        if (toTarget[spur] == INF) return INF;
+
+        ws.reset(g.n);
+        auto &heap = ws.heap;
+        greater<pair<long long,int>> cmp;
+        ws.dist[spur] = 0;
+        ws.touched.push_back(spur);
+        heap.push_back({toTarget[spur], spur});
+
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), cmp);
+            auto [key, u] = heap.back();
+            heap.pop_back();
+            if (key != ws.dist[u] + toTarget[u]) continue;
+            if (key > cutoff) break;
+
+            if (treeRouteClear(u, spur, spurIndex)) {
+                unpackPath(u, ws.parent, path);
+                for (int v = towardTarget[u]; v != -1; v = towardTarget[v]) path.push_back(v);
+                return key;
+            }
+
+            for (auto &e : g.timeGraph[u]) {
+                int v = e.to;
+                if (blockedZone[v] || toTarget[v] == INF || roadBlocked(u, v, spur)) continue;
+                long long nd = ws.dist[u] + e.timeCost;
+                if (nd < ws.dist[v]) {
+                    if (ws.dist[v] == INF) ws.touched.push_back(v);
+                    ws.dist[v] = nd;
+                    ws.parent[v] = u;
+                    heap.push_back({nd + toTarget[v], v});
+                    push_heap(heap.begin(), heap.end(), cmp);
+                }
+            }
+        }
+        return INF;
+    }
+
+    long long roadTime(int u, int v) const {
+        long long best = INF;
+        for (auto &e : g.timeGraph[u])
+            if (e.to == v) best = min(best, (long long)e.timeCost);
+        return best;
+    }
+
+public:
+    AlternativeRouter(const CityGraph &graph, int t) : g(graph), target(t) {
+        shortestTimeTable(g, t, toTarget, towardTarget);
+        blockedZone.assign(g.n, 0);
+        posOnLast.assign(g.n, -1);
+        hitStamp.assign(g.n, 0);
+        hitIndex.assign(g.n, 0);
+    }
+
+    vector<Route> routes(int s, int k) {
+        vector<Route> found;
+        if (k <= 0 || toTarget[s] == INF) return found;
+
+        Route first{toTarget[s], {}};
+        for (int v = s; v != -1; v = towardTarget[v]) first.path.push_back(v);
+        found.push_back(first);
+
+        // Candidates ordered by time; the set also drops duplicate routes
+        // produced by different deviations.
+        set<pair<long long, vector<int>>> candidates;
+
+        while ((int)found.size() < k) {
+            const vector<int> &last = found.back().path;
+            long long rootTime = 0;
+            stamp++;
+            for (size_t i = 0; i < last.size(); i++) posOnLast[last[i]] = i;
+            vector<char> sharesRoot(found.size(), 1);
+            size_t needed = k - found.size();
+
+            for (size_t i = 0; i + 1 < last.size(); i++) {
+                int spur = last[i];
+                if (i > 0) blockedZone[last[i - 1]] = 1;
+
+                // block the next road of every found route sharing this root
+                blockedNext.clear();
+                for (size_t r = 0; r < found.size(); r++) {
+                    const vector<int> &p = found[r].path;
+                    sharesRoot[r] = sharesRoot[r] && p.size() > i + 1 && p[i] == last[i];
+                    if (sharesRoot[r]) blockedNext.push_back(p[i + 1]);
+                }
+
+                // a spur that cannot beat the needed-th candidate is skipped
+                long long cutoff = INF;
+                if (candidates.size() >= needed)
+                    cutoff = next(candidates.begin(), needed - 1)->first - rootTime;
+
+                vector<int> spurPath;
+                long long spurTime = toTarget[spur] > cutoff ? INF
+                                   : spurSearch(spur, i, cutoff, spurPath);
+                if (spurTime != INF) {
+                    vector<int> full(last.begin(), last.begin() + i);
+                    full.insert(full.end(), spurPath.begin(), spurPath.end());
+                    candidates.insert({rootTime + spurTime, move(full)});
+                }
+                rootTime += roadTime(last[i], last[i + 1]);
+            }
+            for (int v : last) {
+                posOnLast[v] = -1;
+                blockedZone[v] = 0;
+            }
+
+            if (candidates.empty()) break;
+            auto best = candidates.begin();
+            found.push_back({best->first, best->second});
+            candidates.erase(best);
+        }
+        return found;
+    }
+};
+
+// -----------------------------------------------------------
+// Contraction Hierarchies
+// -----------------------------------------------------------
+// Preprocessing contracts zones one at a time (lazy edge-difference order),
+// adding a shortcut u-w through v whenever a bounded witness search finds
+// no path from u to w at most as short. Every zone keeps only its arcs to
+// higher-ranked zones, so a query is two small upward Dijkstra searches
+// that meet at the highest zone of the shortest path. Shortcuts remember
+// the zone they bypass and are unpacked back into original roads.
+// Equal-time alternatives may resolve to a different (equally fast) path
+// than dijkstraShortestTime.
+class ContractionHierarchy {
+public:
+    struct Arc { int to; long long w; int mid; }; // mid = -1 for an original road
+
+    int n = 0;
+    vector<int> rank;
+    vector<vector<Arc>> up;
+    long long graphArcs = 0;            // graph the hierarchy was built from
+    unsigned long long graphHash = 0;
+
+    void build(const CityGraph &g) {
+        n = g.n;
+        graphArcs = g.timeArcCount();
+        graphHash = g.timeChecksum();
+        rank.assign(n, -1);
+        up.assign(n, {});
+
+        // working graph: one arc per neighbour pair, minimum time
+        vector<vector<Arc>> adj(n);
+        for (int u = 0; u < n; u++)
+            for (auto &e : g.timeGraph[u])
+                if (e.to != u) addOrLower(adj, u, e.to, e.timeCost, -1);
+
+        witnessDist.assign(n, INF);
+        vector<int> deletedNeighbors(n, 0);
+
+        priority_queue<pair<long long,int>,
+            vector<pair<long long,int>>,
+            greater<pair<long long,int>>> order;
+        for (int v = 0; v < n; v++)
+            order.push({priority(adj, v, deletedNeighbors), v});
+
+        int next = 0;
+        while (!order.empty()) {
+            int v = order.top().second;
+            order.pop();
+            if (rank[v] != -1) continue;
+
+            // lazy update: re-queue if v is no longer the cheapest
+            long long p = priority(adj, v, deletedNeighbors);
+            if (!order.empty() && p > order.top().first) {
+                order.push({p, v});
+                continue;
+            }
+
+            contract(adj, v, true);
+            rank[v] = next++;
+            up[v] = adj[v];
+            for (auto &a : adj[v]) {
+                auto &list = adj[a.to];
+                list.erase(remove_if(list.begin(), list.end(),
+                                     [v](const Arc &x) { return x.to == v; }),
+                           list.end());
+                deletedNeighbors[a.to]++;
+            }
+            vector<Arc>().swap(adj[v]);
+        }
+        witnessDist.clear();
+        initQuery();
+    }
+
+    // Binary layout: "CH1", n, graph arc count, graph checksum, rank[n],
+    // then per zone: arc count, arcs.
+    bool save(const string &file) const {
+        ofstream out(file, ios::binary);
+        if (!out.is_open()) return false;
+        out.write("CH1", 4);
+        out.write((const char *)&n, sizeof(n));
+        out.write((const char *)&graphArcs, sizeof(graphArcs));
+        out.write((const char *)&graphHash, sizeof(graphHash));
+        out.write((const char *)rank.data(), n * sizeof(int));
+        for (auto &arcs : up) {
+            int cnt = arcs.size();
+            out.write((const char *)&cnt, sizeof(cnt));
+            out.write((const char *)arcs.data(), cnt * sizeof(Arc));
+        }
+        return (bool)out;
+    }
+
+    // Fails (so the caller rebuilds) unless the file was built from g's roads.
+    bool load(const string &file, const CityGraph &g) {
+        ifstream in(file, ios::binary);
+        char magic[4];
+        if (!in.read(magic, 4) || string(magic, 4) != string("CH1", 4)) return false;
+        in.read((char *)&n, sizeof(n));
+        in.read((char *)&graphArcs, sizeof(graphArcs));
+        in.read((char *)&graphHash, sizeof(graphHash));
+        if (!in || n != g.n || graphArcs != g.timeArcCount() || graphHash != g.timeChecksum())
+            return false;
+
+        rank.resize(n);
+        up.assign(n, {});
+        in.read((char *)rank.data(), n * sizeof(int));
+        for (auto &arcs : up) {
+            int cnt = 0;
+            in.read((char *)&cnt, sizeof(cnt));
+            if (!in || cnt < 0) return false;
+            arcs.resize(cnt);
+            in.read((char *)arcs.data(), cnt * sizeof(Arc));
+        }
+        if (!in) return false;
+        initQuery();
+        return true;
+    }
+
+    // Travel time from s to t (INF if unreachable); fills path with zones.
+    // Reuses internal buffers, so one hierarchy serves one query at a time.
+    long long query(int s, int t, vector<int> &path) {
+        path.clear();
+        for (int v : touched) {
+            distF[v] = distB[v] = INF;
+            parF[v] = parB[v] = -1;
+        }
+        touched.clear();
+
+        using QItem = pair<long long,int>;
+        priority_queue<QItem, vector<QItem>, greater<QItem>> pqF, pqB;
+        distF[s] = 0; distB[t] = 0;
+        touched.push_back(s); touched.push_back(t);
+        pqF.push({0, s});
+        pqB.push({0, t});
+
+        long long best = INF;
+        int meet = -1;
+
+        auto step = [&](priority_queue<QItem, vector<QItem>, greater<QItem>> &pq,
+                        vector<long long> &dist, vector<int> &par,
+                        const vector<long long> &other) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > dist[u]) return;
+            if (other[u] != INF && d + other[u] < best) {
+                best = d + other[u];
+                meet = u;
+            }
+            // stall-on-demand: a higher zone already reaches u more cheaply
+            for (auto &a : up[u])
+                if (dist[a.to] != INF && dist[a.to] + a.w < d) return;
+
+            for (auto &a : up[u]) {
+                if (d + a.w < dist[a.to]) {
+                    if (dist[a.to] == INF && other[a.to] == INF) touched.push_back(a.to);
+                    dist[a.to] = d + a.w;
+                    par[a.to] = u;
+                    pq.push({dist[a.to], a.to});
+                }
+            }
+        };
+
+        while (true) {
+            bool fOpen = !pqF.empty() && pqF.top().first < best;
+            bool bOpen = !pqB.empty() && pqB.top().first < best;
+            if (!fOpen && !bOpen) break;
+            if (fOpen && (!bOpen || pqF.top().first <= pqB.top().first))
+                step(pqF, distF, parF, distB);
+            else
+                step(pqB, distB, parB, distF);
+        }
+        if (meet == -1) return INF;
+
+        vector<int> upward;
+        for (int v = meet; v != -1; v = parF[v]) upward.push_back(v);
+        reverse(upward.begin(), upward.end());
+        vector<int> hops = upward;
+        for (int v = parB[meet]; v != -1; v = parB[v]) hops.push_back(v);
+
+        path.push_back(hops[0]);
+        for (size_t i = 1; i < hops.size(); i++) unpack(hops[i - 1], hops[i], path);
+        return best;
+    }
+
+private:
+    vector<long long> witnessDist;
+    vector<int> witnessTouched;
+
+    vector<long long> distF, distB;
+    vector<int> parF, parB, touched;
+
+    void initQuery() {
+        distF.assign(n, INF);
+        distB.assign(n, INF);
+        parF.assign(n, -1);
+        parB.assign(n, -1);
+        touched.clear();
+    }
+
+    static void addOrLower(vector<vector<Arc>> &adj, int u, int v, long long w, int mid) {
+        for (auto &a : adj[u]) {
+            if (a.to == v) {
+                if (w < a.w) a = {v, w, mid};
+                return;
+            }
+        }
+        adj[u].push_back({v, w, mid});
+    }
+
+    // Bounded Dijkstra from src in the remaining graph, skipping `skip`.
+    void witnessSearch(const vector<vector<Arc>> &adj, int src, int skip, long long limit) {
+        for (int v : witnessTouched) witnessDist[v] = INF;
+        witnessTouched.clear();
+
+        priority_queue<pair<long long,int>,
+            vector<pair<long long,int>>,
+            greater<pair<long long,int>>> pq;
+        witnessDist[src] = 0;
+        witnessTouched.push_back(src);
+        pq.push({0, src});
+
+        int settled = 0;
+        while (!pq.empty() && settled < 500) {
+            auto [d, u] = pq.top();
+            pq.pop();
+            if (d > witnessDist[u]) continue;
+            if (d > limit) break;
+            settled++;
+            for (auto &a : adj[u]) {
+                if (a.to == skip) continue;
+                if (d + a.w < witnessDist[a.to]) {
+                    if (witnessDist[a.to] == INF) witnessTouched.push_back(a.to);
+                    witnessDist[a.to] = d + a.w;
+                    pq.push({witnessDist[a.to], a.to});
+                }
+            }
+        }
+    }
+
+    // Returns the number of shortcuts contracting v needs; adds them if apply.
+    int contract(vector<vector<Arc>> &adj, int v, bool apply) {
+        vector<Arc> nb = adj[v];
+        int shortcuts = 0;
+        for (size_t i = 0; i < nb.size(); i++) {
+            if (i + 1 == nb.size()) break;
+            long long limit = 0;
+            for (size_t j = i + 1; j < nb.size(); j++) limit = max(limit, nb[i].w + nb[j].w);
+
+            witnessSearch(adj, nb[i].to, v, limit);
+            for (size_t j = i + 1; j < nb.size(); j++) {
+                long long via = nb[i].w + nb[j].w;
+                if (witnessDist[nb[j].to] <= via) continue;
+                shortcuts++;
+                if (apply) {
+                    addOrLower(adj, nb[i].to, nb[j].to, via, v);
+                    addOrLower(adj, nb[j].to, nb[i].to, via, v);
+                }
+            }
+        }
+        return shortcuts;
+    }
+
+    long long priority(vector<vector<Arc>> &adj, int v, const vector<int> &deletedNeighbors) {
+        int degree = adj[v].size();
+        return (long long)contract(adj, v, false) - degree + 2LL * deletedNeighbors[v];
+    }
+
+    const Arc *findArc(int a, int b) const {
+        int low = rank[a] < rank[b] ? a : b, high = low == a ? b : a;
+        for (auto &arc : up[low])
+            if (arc.to == high) return &arc;
+        return nullptr;
+    }
+
+    // Appends the original zones after `from` on the arc from -> to.
+    void unpack(int from, int to, vector<int> &path) const {
+        vector<pair<int,int>> stk = {{from, to}};
+        while (!stk.empty()) {
+            auto [a, b] = stk.back();
+            stk.pop_back();
+            const Arc *arc = findArc(a, b);
+            if (!arc || arc->mid == -1) {
+                path.push_back(b);
+                continue;
+            }
+            stk.push_back({arc->mid, b});
+            stk.push_back({a, arc->mid});
+        }
+    }
+};
+
+// -----------------------------------------------------------
+// ALT landmarks + bidirectional A*
+// -----------------------------------------------------------
+// A handful of landmarks are picked by farthest-point selection and their
+// travel times to every zone are stored. By the triangle inequality
+// |d(L,t) - d(L,v)| <= d(v,t), which gives an A* lower bound. The query
+// runs A* from both ends with averaged potentials (so both directions see
+// the same reduced road times) and stops once the two smallest keys add up
+// to the best meeting time found.
+class LandmarkRouter {
+public:
+    int n = 0, k = 0;
+    vector<int> landmarks;
+    vector<long long> landmarkDist; // landmarkDist[i * n + v]
+    long long settled = 0;          // zones settled by the last query
+    long long graphArcs = 0;        // graph the landmarks were computed on
+    unsigned long long graphHash = 0;
+
+    void build(const CityGraph &g, int count) {
+        n = g.n;
+        graphArcs = g.timeArcCount();
+        graphHash = g.timeChecksum();
+        landmarks.clear();
+        landmarkDist.clear();
+        if (n == 0) return;
+
+        vector<long long> dist, closest(n, INF);
+        vector<int> parent;
+
+        // start from the zone farthest from zone 0
+        dijkstraShortestTime(g, 0, dist, parent);
+        int next = 0;
+        for (int v = 0; v < n; v++)
+            if (dist[v] != INF && dist[v] > dist[next]) next = v;
+
+        while ((int)landmarks.size() < min(count, n)) {
+            landmarks.push_back(next);
+            dijkstraShortestTime(g, next, dist, parent);
+            landmarkDist.insert(landmarkDist.end(), dist.begin(), dist.end());
+
+            // next landmark: farthest from all chosen ones; zones no landmark
+            // reaches yet come first so every component gets covered
+            for (int v = 0; v < n; v++) closest[v] = min(closest[v], dist[v]);
+            next = -1;
+            for (int v = 0; v < n; v++) {
+                if (next == -1 || (closest[v] == INF && closest[next] != INF) ||
+                    ((closest[v] == INF) == (closest[next] == INF) && closest[v] > closest[next]))
+                    next = v;
+            }
+            if (closest[next] == 0) break;
+        }
+        k = landmarks.size();
+        initQuery();
+    }
+
+    // Binary layout: "AL1", n, graph arc count, graph checksum, k,
+    // landmarks[k], landmarkDist[k * n].
+    bool save(const string &file) const {
+        ofstream out(file, ios::binary);
+        if (!out.is_open()) return false;
+        out.write("AL1", 4);
+        out.write((const char *)&n, sizeof(n));
+        out.write((const char *)&graphArcs, sizeof(graphArcs));
+        out.write((const char *)&graphHash, sizeof(graphHash));
+        out.write((const char *)&k, sizeof(k));
+        out.write((const char *)landmarks.data(), k * sizeof(int));
+        out.write((const char *)landmarkDist.data(), landmarkDist.size() * sizeof(long long));
+        return (bool)out;
     }
 
-    void addTimeEdge(int u, int v, int t) {
-        if (u<0 || v<0 || u>=n || v>=n) return;
-        timeGraph[u].push_back({v, t});
-        timeGraph[v].push_back({u, t});
+    // Fails (so the caller rebuilds) unless the distances were computed on
+    // g's roads; stale distances would make the A* bounds inadmissible.
+    bool load(const string &file, const CityGraph &g) {
+        ifstream in(file, ios::binary);
+        char magic[4];
+        if (!in.read(magic, 4) || string(magic, 4) != string("AL1", 4)) return false;
+        in.read((char *)&n, sizeof(n));
+        in.read((char *)&graphArcs, sizeof(graphArcs));
+        in.read((char *)&graphHash, sizeof(graphHash));
+        in.read((char *)&k, sizeof(k));
+        if (!in || n != g.n || k < 0 || graphArcs != g.timeArcCount() ||
+            graphHash != g.timeChecksum())
+            return false;
+        landmarks.resize(k);
+        landmarkDist.resize((size_t)k * n);
+        in.read((char *)landmarks.data(), k * sizeof(int));
+        in.read((char *)landmarkDist.data(), landmarkDist.size() * sizeof(long long));
+        if (!in) return false;
+        initQuery();
+        return true;
     }
 
-    void addSimpleEdge(int u, int v) {
-        if (u<0 || v<0 || u>=n || v>=n) return;
-        simpleGraph[u].push_back({v});
-        simpleGraph[v].push_back({u});
+    // Lower bound on d(v, t); INF if some landmark proves t unreachable.
+    long long lowerBound(int v, int t) const {
+        long long best = 0;
+        for (int i = 0; i < k; i++) {
+            long long dv = landmarkDist[(size_t)i * n + v], dt = landmarkDist[(size_t)i * n + t];
+            if ((dv == INF) != (dt == INF)) return INF;
+            if (dv != INF) best = max(best, llabs(dt - dv));
+        }
+        return best;
     }
-};
 
-// -----------------------------------------------------------
-// Dijkstra
-// -----------------------------------------------------------
-void dijkstraShortestTime(const CityGraph &g, int src,
-                          vector<long long> &dist,
-                          vector<int> &parent) {
-    dist.assign(g.n, INF);
-    parent.assign(g.n, -1);
+    long long query(const CityGraph &g, int s, int t, vector<int> &path) {
+        path.clear();
+        settled = 0;
+        for (int v : touched) {
+            distF[v] = distB[v] = INF;
+            parF[v] = parB[v] = -1;
+        }
+        touched.clear();
+        if (lowerBound(s, t) == INF) return INF;
 
-    priority_queue<pair<long long,int>,
-        vector<pair<long long,int>>,
-        greater<pair<long long,int>>> pq;
+        // doubled forward potential: pf2(v) = bound(v, t) - bound(s, v)
+        auto pf2 = [&](int v) { return lowerBound(v, t) - lowerBound(v, s); };
 
-    dist[src] = 0;
-    pq.push({0, src});
+        using QItem = pair<long long,int>;
+        priority_queue<QItem, vector<QItem>, greater<QItem>> pqF, pqB;
+        distF[s] = 0; distB[t] = 0;
+        touched.push_back(s); touched.push_back(t);
+        pqF.push({pf2(s), s});
+        pqB.push({-pf2(t), t});
 
-    while (!pq.empty()) {
-        auto [curDist, u] = pq.top();
-        pq.pop();
-        if (curDist > dist[u]) continue;
+        long long best = INF;
+        int meet = -1;
 
-        for (auto &e : g.timeGraph[u]) {
-            int v = e.to;
-            long long w = e.timeCost;
-            if (dist[u] + w < dist[v]) {
-                dist[v] = dist[u] + w;
-                parent[v] = u;
-                pq.push({dist[v], v});
+        auto step = [&](priority_queue<QItem, vector<QItem>, greater<QItem>> &pq,
+                        vector<long long> &dist, vector<int> &par,
+                        const vector<long long> &other, int sign) {
+            auto [key, u] = pq.top();
+            pq.pop();
+            if (key != 2 * dist[u] + sign * pf2(u)) return; // stale entry
+            settled++;
+            if (other[u] != INF && dist[u] + other[u] < best) {
+                best = dist[u] + other[u];
+                meet = u;
             }
+            for (auto &e : g.timeGraph[u]) {
+                long long nd = dist[u] + e.timeCost;
+                if (nd < dist[e.to]) {
+                    if (dist[e.to] == INF && other[e.to] == INF) touched.push_back(e.to);
+                    dist[e.to] = nd;
+                    par[e.to] = u;
+                    pq.push({2 * nd + sign * pf2(e.to), e.to});
+                }
+            }
+        };
+
+        while (!pqF.empty() && !pqB.empty()) {
+            if (best != INF && pqF.top().first + pqB.top().first >= 2 * best) break;
+            if (pqF.top().first <= pqB.top().first)
+                step(pqF, distF, parF, distB, 1);
+            else
+                step(pqB, distB, parB, distF, -1);
         }
+        if (meet == -1) return INF;
+
+        for (int v = meet; v != -1; v = parF[v]) path.push_back(v);
+        reverse(path.begin(), path.end());
+        for (int v = parB[meet]; v != -1; v = parB[v]) path.push_back(v);
+        return best;
     }
-}
+
+private:
+    vector<long long> distF, distB;
+    vector<int> parF, parB, touched;
+
+    void initQuery() {
+        distF.assign(n, INF);
+        distB.assign(n, INF);
+        parF.assign(n, -1);
+        parB.assign(n, -1);
+        touched.clear();
+    }
+};
 
 // -----------------------------------------------------------
-// BFS (unweighted)
+// Traffic assignment (user equilibrium, Frank-Wolfe)
 // -----------------------------------------------------------
-void bfsUnweighted(const CityGraph &g, int src,
-                   vector<int> &dist,
-                   vector<int> &parent) {
-    dist.assign(g.n, -1);
-    parent.assign(g.n, -1);
+// Every road is two directed links whose travel time grows with flow by
+// the BPR curve t0 * (1 + 0.15 (x/c)^4). Each iteration loads the whole
+// OD demand onto the current shortest paths (all-or-nothing, one Dijkstra
+// per origin, origins split into fixed blocks per thread), then moves the
+// flows toward that load by the step that minimises the Beckmann objective.
+// The relative gap (TSTT - SPTT) / TSTT goes to 0 at equilibrium.
+const double DEFAULT_ROAD_CAPACITY = 1800; // vehicles per hour per direction
+const double BPR_ALPHA = 0.15, BPR_BETA = 4;
 
-    queue<int> q;
-    dist[src] = 0;
-    q.push(src);
+struct AssignmentLink {
+    int from, to;
+    double freeTime, capacity;
+    double flow = 0;
+};
 
-    while (!q.empty()) {
-        int u = q.front();
-        q.pop();
+inline double bprTime(const AssignmentLink &l, double flow) {
+    if (l.capacity <= 0) return l.freeTime;
+    double r = flow / l.capacity;
+    return l.freeTime * (1 + BPR_ALPHA * r * r * r * r);
+}
 
-        for (auto &e : g.simpleGraph[u]) {
-            int v = e.to;
-            if (dist[v] == -1) {
-                dist[v] = dist[u] + 1;
-                parent[v] = u;
-                q.push(v);
+class TrafficAssignment {
+    struct Workspace {
+        vector<double> dist, load, flow;
+        vector<int> parentLink, order;
+        vector<pair<double,int>> heap;
+        double sptt = 0, unassigned = 0;
+    };
+
+    vector<vector<int>> out; // link ids leaving each zone
+    vector<int> origins;
+    vector<Workspace> ws; // one per thread, kept across iterations
+
+    // Shortest paths from o under cost, then push each destination's trips
+    // back along the tree in reverse settle order: O(V) on top of Dijkstra.
+    void loadOrigin(int o, const vector<double> &cost, Workspace &w) const {
+        for (int v : w.order) {
+            w.dist[v] = INF;
+            w.parentLink[v] = -1;
+        }
+        w.order.clear();
+        w.heap.clear();
+        w.dist[o] = 0;
+        w.heap.push_back({0, o});
+
+        while (!w.heap.empty()) {
+            pop_heap(w.heap.begin(), w.heap.end(), greater<>());
+            auto [d, u] = w.heap.back();
+            w.heap.pop_back();
+            if (d > w.dist[u]) continue;
+            w.order.push_back(u);
+            for (int id : out[u]) {
+                int v = links[id].to;
+                double nd = d + cost[id];
+                if (nd < w.dist[v]) {
+                    w.dist[v] = nd;
+                    w.parentLink[v] = id;
+                    w.heap.push_back({nd, v});
+                    push_heap(w.heap.begin(), w.heap.end(), greater<>());
+                }
             }
         }
+
+        for (auto [d, trips] : demand[o]) {
+            if (w.dist[d] == INF) { w.unassigned += trips; continue; }
+            w.load[d] += trips;
+            w.sptt += trips * w.dist[d];
+        }
+        // Children settle after their parent, so walking the settle order
+        // backwards pushes each zone's load before its parent link's.
+        for (int i = w.order.size() - 1; i >= 0; i--) {
+            int v = w.order[i];
+            if (w.load[v] == 0 || v == o) continue;
+            int id = w.parentLink[v];
+            w.flow[id] += w.load[v];
+            w.load[links[id].from] += w.load[v];
+            w.load[v] = 0;
+        }
+        w.load[o] = 0;
     }
-}
 
-// -----------------------------------------------------------
-// Path builder
-// -----------------------------------------------------------
-vector<int> reconstructPath(int target, const vector<int> &parent) {
-    vector<int> path;
-    for (int cur = target; cur != -1; cur = parent[cur])
-        path.push_back(cur);
-    reverse(path.begin(), path.end());
-    return path;
-}
+    // All-or-nothing load of the whole demand; returns SPTT. Thread t owns
+    // the fixed block of origins [t·O/T, (t+1)·O/T) and the per-thread sums
+    // are added in thread order, so for a given thread count the floating
+    // point summation order, and with it every flow, is the same each run.
+    double allOrNothing(const vector<double> &cost, vector<double> &target, int threads) {
+        ws.resize(threads);
+        auto worker = [&](int t) {
+            Workspace &w = ws[t];
+            if (w.dist.size() != (size_t)n) {
+                w.dist.assign(n, INF);
+                w.load.assign(n, 0);
+                w.parentLink.assign(n, -1);
+            }
+            w.flow.assign(links.size(), 0);
+            w.sptt = w.unassigned = 0;
+            size_t O = origins.size();
+            for (size_t i = O * t / threads; i < O * (t + 1) / threads; i++)
+                loadOrigin(origins[i], cost, w);
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+        worker(0);
+        for (auto &th : pool) th.join();
 
-void printPath(const vector<int> &path, const vector<string> &names) {
-    for (size_t i = 0; i < path.size(); i++) {
-        cout << names[path[i]];
-        if (i + 1 != path.size()) cout << " -> ";
+        double sptt = 0;
+        unassigned = 0;
+        target.assign(links.size(), 0);
+        for (int t = 0; t < threads; t++) {
+            const Workspace &w = ws[t];
+            for (size_t id = 0; id < links.size(); id++) target[id] += w.flow[id];
+            sptt += w.sptt;
+            unassigned += w.unassigned;
+        }
+        return sptt;
     }
-    cout << "\n";
-}
+
+    // Step in [0,1] minimising the Beckmann objective along x + s(y - x):
+    // its derivative sum (y - x) t(x + s(y - x)) is increasing, so bisect.
+    double lineSearch(const vector<double> &y) const {
+        double lo = 0, hi = 1;
+        for (int it = 0; it < 30; it++) {
+            double mid = (lo + hi) / 2, slope = 0;
+            for (size_t id = 0; id < links.size(); id++) {
+                double dir = y[id] - links[id].flow;
+                if (dir != 0) slope += dir * bprTime(links[id], links[id].flow + mid * dir);
+            }
+            (slope > 0 ? hi : lo) = mid;
+        }
+        return (lo + hi) / 2;
+    }
+
+public:
+    int n;
+    vector<AssignmentLink> links;
+    vector<vector<pair<int,double>>> demand; // per origin: (destination, trips)
+    double totalDemand = 0, unassigned = 0;
+
+    TrafficAssignment(int zones) : out(zones), n(zones), demand(zones) {}
+
+    void addRoad(int u, int v, double freeTime, double capacity) {
+        if (u<0 || v<0 || u>=n || v>=n) return;
+        out[u].push_back(links.size());
+        links.push_back({u, v, freeTime, capacity});
+        out[v].push_back(links.size());
+        links.push_back({v, u, freeTime, capacity});
+    }
+
+    void addDemand(int o, int d, double trips) {
+        if (o<0 || d<0 || o>=n || d>=n || o == d || trips <= 0) return;
+        if (demand[o].empty()) origins.push_back(o);
+        demand[o].push_back({d, trips});
+        totalDemand += trips;
+    }
+
+    double totalTravelTime() const {
+        double tstt = 0;
+        for (auto &l : links) tstt += l.flow * bprTime(l, l.flow);
+        return tstt;
+    }
+
+    // Runs until the relative gap drops below targetGap or maxIter
+    // iterations, printing one line per iteration. Returns the final gap.
+    double solve(int maxIter, double targetGap, int threads) {
+        threads = max(1, threads);
+        vector<double> cost(links.size()), y;
+        for (size_t id = 0; id < links.size(); id++) cost[id] = links[id].freeTime;
+        allOrNothing(cost, y, threads);
+        for (size_t id = 0; id < links.size(); id++) links[id].flow = y[id];
+
+        cout << "Origins: " << origins.size() << "  Trips: " << totalDemand
+             << "  Links: " << links.size() << "  Threads: " << threads << "\n";
+        cout << left << setw(6) << "Iter" << setw(14) << "Gap" << setw(12) << "Step"
+             << setw(14) << "TSTT" << setw(10) << "AON ms" << setw(10) << "Step ms"
+             << "Total ms\n";
+
+        double gap = INF;
+        auto startAll = chrono::steady_clock::now();
+        for (int iter = 1; iter <= maxIter; iter++) {
+            auto start = chrono::steady_clock::now();
+            for (size_t id = 0; id < links.size(); id++) cost[id] = bprTime(links[id], links[id].flow);
+            double sptt = allOrNothing(cost, y, threads);
+            auto mid = chrono::steady_clock::now();
+
+            double tstt = 0;
+            for (size_t id = 0; id < links.size(); id++) tstt += links[id].flow * cost[id];
+            gap = tstt > 0 ? (tstt - sptt) / tstt : 0;
+
+            double step = 0;
+            if (gap > targetGap) {
+                step = lineSearch(y);
+                for (size_t id = 0; id < links.size(); id++)
+                    links[id].flow += step * (y[id] - links[id].flow);
+            }
+            auto end = chrono::steady_clock::now();
+
+            cout << left << setw(6) << iter << setw(14) << gap << setw(12) << step
+                 << setw(14) << (long long)tstt
+                 << setw(10) << chrono::duration<double, milli>(mid - start).count()
+                 << setw(10) << chrono::duration<double, milli>(end - mid).count()
+                 << chrono::duration<double, milli>(end - startAll).count() << "\n";
+            if (gap <= targetGap) break;
+        }
+        if (unassigned > 0)
+            cout << "Unassigned trips (no route): " << unassigned << "\n";
+        return gap;
+    }
+
+    bool writeCSV(const string &file) const {
+        ofstream outFile(file);
+        if (!outFile.is_open()) return false;
+        outFile << "u,v,flow,capacity,freeTime,time\n";
+        for (auto &l : links)
+            outFile << l.from << "," << l.to << "," << l.flow << "," << l.capacity << ","
+                    << l.freeTime << "," << bprTime(l, l.flow) << "\n";
+        return true;
+    }
+};
 
 // -----------------------------------------------------------
 // CSV Loader
@@ -167,6 +1988,53 @@ void loadRoadsCSV(CityGraph &g) {
     }
 }
 
+// roads.csv again, with an optional fourth column: capacity per direction.
+void loadAssignmentRoads(TrafficAssignment &ta) {
+    ifstream fin("roads.csv");
+    if (!fin.is_open()) {
+        cout << "Error: roads.csv not found.\n";
+        exit(0);
+    }
+
+    string line;
+    getline(fin, line); // skip header
+
+    while (getline(fin, line)) {
+        stringstream ss(line);
+        string uStr, vStr, tStr, capStr;
+
+        getline(ss, uStr, ',');
+        getline(ss, vStr, ',');
+        getline(ss, tStr, ',');
+        getline(ss, capStr, ',');
+
+        double cap = capStr.empty() ? DEFAULT_ROAD_CAPACITY : stod(capStr);
+        ta.addRoad(stoi(uStr), stoi(vStr), stoi(tStr), cap);
+    }
+}
+
+// OD demand as origin,destination,trips rows.
+bool loadODCSV(const string &file, TrafficAssignment &ta) {
+    ifstream fin(file);
+    if (!fin.is_open()) return false;
+
+    string line;
+    getline(fin, line); // skip header
+
+    while (getline(fin, line)) {
+        stringstream ss(line);
+        string oStr, dStr, tripStr;
+
+        getline(ss, oStr, ',');
+        getline(ss, dStr, ',');
+        getline(ss, tripStr, ',');
+        if (tripStr.empty()) continue;
+
+        ta.addDemand(stoi(oStr), stoi(dStr), stod(tripStr));
+    }
+    return true;
+}
+
 // -----------------------------------------------------------
 // Display tables
 // -----------------------------------------------------------
@@ -218,13 +2086,186 @@ void printBFSTable(const vector<int> &dist,
     }
 }
 
+// -----------------------------------------------------------
+// Resident query mode
+// -----------------------------------------------------------
+// Graph is loaded once; each stdin line is a query:
+//   "s t" -> travel time and path from s to t
+//   "s"   -> travel times from s to every zone (INF = unreachable)
+// Latency percentiles and throughput go to stderr at end of input.
+// A pairQuery (CH, ALT, ...) answers "s t" lines instead of Dijkstra.
+// With a tree cache, queries reuse cached trees; "add u v t" adds a road
+// and "update u v t" retimes one, repairing the cached trees.
+using PairQuery = function<long long(int, int, vector<int> &)>;
+
+void serveQueries(CityGraph &g, const vector<string> &names,
+                  PairQuery pairQuery = nullptr,
+                  ShortestPathTreeCache *cache = nullptr) {
+    SearchWorkspace ws;
+    vector<int> pairPath;
+    vector<double> latencyUs;
+    string line;
+
+    auto startAll = chrono::steady_clock::now();
+    while (getline(cin, line)) {
+        stringstream ss(line);
+        string first;
+        if (!(ss >> first)) continue;
+
+        if (first == "add" && cache) {
+            int u, v, t;
+            if (ss >> u >> v >> t) {
+                if (u < 0 || v < 0 || u >= g.n || v >= g.n || t < 0) {
+                    cout << "Invalid road " << u << " " << v << " " << t << "\n";
+                    continue;
+                }
+                cache->lastTouched = 0;
+                g.addTimeEdge(u, v, t);
+                g.addSimpleEdge(u, v);
+                cout << "added " << u << " " << v << " " << t
+                     << " touched " << cache->lastTouched << "\n";
+            }
+            continue;
+        }
+        if (first == "update" && cache) {
+            int u, v, t;
+            if (ss >> u >> v >> t) {
+                if (t < 0) {
+                    cout << "Invalid road " << u << " " << v << " " << t << "\n";
+                    continue;
+                }
+                cache->lastTouched = 0;
+                if (g.updateTimeEdge(u, v, t))
+                    cout << "updated " << u << " " << v << " " << t
+                         << " touched " << cache->lastTouched << "\n";
+                else
+                    cout << "No road " << u << " " << v << "\n";
+            }
+            continue;
+        }
+
+        // "s" or "s -1" is one-to-all, "s t" one pair; anything else is rejected
+        int s, t = -1;
+        string extra;
+        stringstream qs(line);
+        if (!(qs >> s)) continue;
+        if (qs >> extra) {
+            size_t used = 0;
+            try {
+                t = stoi(extra, &used);
+            } catch (...) {
+                used = 0;
+            }
+            if (used != extra.size() || qs >> extra) t = -2;
+        }
+        if (s < 0 || s >= g.n || t < -1 || t >= g.n) {
+            cout << "Invalid query: " << line << "\n";
+            continue;
+        }
+
+        auto start = chrono::steady_clock::now();
+
+        const vector<long long> *dist = &ws.dist;
+        const vector<int> *parent = &ws.parent;
+        if (pairQuery && t >= 0) {
+            long long d = pairQuery(s, t, pairPath);
+            if (d == INF) {
+                cout << s << " " << t << " INF unreachable\n";
+            } else {
+                cout << s << " " << t << " " << d << " ";
+                printPath(pairPath, names);
+            }
+            latencyUs.push_back(chrono::duration<double, micro>(
+                chrono::steady_clock::now() - start).count());
+            continue;
+        }
+
+        if (cache) {
+            const ShortestPathTree &tree = cache->get(s);
+            dist = &tree.dist;
+            parent = &tree.parent;
+        } else {
+            dijkstraShortestTime(g, s, ws, t);
+        }
+
+        if (t >= 0) {
+            if ((*dist)[t] == INF) {
+                cout << s << " " << t << " INF unreachable\n";
+            } else {
+                cout << s << " " << t << " " << (*dist)[t] << " ";
+                unpackPath(t, *parent, pairPath);
+                printPath(pairPath, names);
+            }
+        } else {
+            cout << s;
+            for (int v = 0; v < g.n; v++) {
+                if ((*dist)[v] == INF) cout << " INF";
+                else cout << " " << (*dist)[v];
+            }
+            cout << "\n";
+        }
+        latencyUs.push_back(chrono::duration<double, micro>(
+            chrono::steady_clock::now() - start).count());
+    }
+    cout.flush();
+
+    double totalSec = chrono::duration<double>(chrono::steady_clock::now() - startAll).count();
+    if (latencyUs.empty()) return;
+
+    sort(latencyUs.begin(), latencyUs.end());
+    auto pct = [&](double p) {
+        return latencyUs[min(latencyUs.size() - 1, (size_t)(p * latencyUs.size()))];
+    };
+    cerr << "Queries: " << latencyUs.size()
+         << "  p50: " << pct(0.50) << " us"
+         << "  p99: " << pct(0.99) << " us"
+         << "  QPS: " << latencyUs.size() / max(totalSec, 1e-9) << "\n";
+    if (cache)
+        cerr << "Tree cache: " << cache->hits << " hits, " << cache->misses << " misses, "
+             << cache->evictions << " evictions, " << cache->repairs << " repairs ("
+             << cache->nodesTouched << " nodes touched), "
+             << cache->bytesUsed << " / " << cache->byteBudget << " bytes\n";
+}
+
 // -----------------------------------------------------------
 // MAIN
 // -----------------------------------------------------------
-int main() {
+// Usage: P2 [serve [ch|alt [file] | cache [MB]] | ch-build [file] | ch-check [file]
+//           | repair-check
+//           | bfs-bench [n] | sssp-bench [n] | delta-bench [n] [threads] [delta]
+//           | alt-build [count] [file]
+//           | route s t [file] | tree s [file] [time|hops] | path treefile t
+//           | isochrone budgets [zone ...] | alternatives s t [k]
+//           | assign [od.csv] [iterations] [threads] [gap]]
+int main(int argc, char *argv[]) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "bfs-bench") {
+        runBFSBenchmark(argc > 2 ? max(4, atoi(argv[2])) : 1000000);
+        return 0;
+    }
+
+    if (mode == "delta-bench") {
+        int threads = argc > 3 ? max(1, atoi(argv[3]))
+                               : (int)max(1u, thread::hardware_concurrency());
+        runDeltaSteppingBenchmark(argc > 2 ? max(4, atoi(argv[2])) : 1000000, threads,
+                                  argc > 4 ? max(1, atoi(argv[4])) : 8);
+        return 0;
+    }
+
+    if (mode == "repair-check") {
+        runRepairCheck();
+        return 0;
+    }
+
+    if (mode == "sssp-bench") {
+        runSSSPBenchmark(argc > 2 ? max(4, atoi(argv[2])) : 1000000);
+        return 0;
+    }
+
     vector<string> names;
     loadZonesCSV(names);
 
@@ -233,6 +2274,248 @@ int main() {
 
     loadRoadsCSV(city);
 
+    // Contraction hierarchy: load from file, or build and save it
+    auto loadOrBuildCH = [&](ContractionHierarchy &ch, const string &file, bool rebuild) {
+        if (!rebuild && ch.load(file, city)) return;
+        auto start = chrono::steady_clock::now();
+        ch.build(city);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        bool saved = ch.save(file);
+        cerr << "CH built in " << sec << " s" << (saved ? ", saved to " : ", could not save ")
+             << file << "\n";
+    };
+
+    // ALT landmarks: load from file, or pick them and save
+    auto loadOrBuildALT = [&](LandmarkRouter &alt, int count, const string &file, bool rebuild) {
+        if (!rebuild && alt.load(file, city)) return;
+        alt.build(city, count);
+        bool saved = alt.save(file);
+        cerr << alt.k << " landmarks" << (saved ? " saved to " : ", could not save ") << file << "\n";
+    };
+
+    if (mode == "serve") {
+        string sub = argc > 2 ? argv[2] : "";
+        if (sub == "ch") {
+            ContractionHierarchy ch;
+            loadOrBuildCH(ch, argc > 3 ? argv[3] : "roads.ch", false);
+            serveQueries(city, names, [&](int a, int b, vector<int> &path) {
+                return ch.query(a, b, path);
+            });
+        } else if (sub == "cache") {
+            size_t mb = argc > 3 ? max(1, atoi(argv[3])) : 256;
+            ShortestPathTreeCache cache(city, mb << 20);
+            serveQueries(city, names, nullptr, &cache);
+        } else if (sub == "alt") {
+            LandmarkRouter alt;
+            loadOrBuildALT(alt, 16, argc > 3 ? argv[3] : "roads.alt", false);
+            serveQueries(city, names, [&](int a, int b, vector<int> &path) {
+                return alt.query(city, a, b, path);
+            });
+        } else {
+            serveQueries(city, names);
+        }
+        return 0;
+    }
+
+    if (mode == "assign") {
+        string odFile = argc > 2 ? argv[2] : "od.csv";
+        int iterations = argc > 3 ? max(1, atoi(argv[3])) : 100;
+        int threads = argc > 4 ? max(1, atoi(argv[4]))
+                               : (int)max(1u, thread::hardware_concurrency());
+        double targetGap = argc > 5 ? atof(argv[5]) : 1e-4;
+
+        TrafficAssignment ta(n);
+        loadAssignmentRoads(ta);
+        if (!loadODCSV(odFile, ta)) {
+            cout << "Error: " << odFile << " not found.\n";
+            return 0;
+        }
+        ta.solve(iterations, targetGap, threads);
+        if (ta.writeCSV("assignment.csv"))
+            cout << "Link flows written to assignment.csv\n";
+        return 0;
+    }
+
+    if (mode == "alt-build") {
+        LandmarkRouter alt;
+        loadOrBuildALT(alt, argc > 2 ? max(1, atoi(argv[2])) : 16,
+                       argc > 3 ? argv[3] : "roads.alt", true);
+        return 0;
+    }
+
+    if (mode == "isochrone") {
+        // budgets as "5,10,15"; facility zones from argv or one per stdin line
+        vector<long long> budgets;
+        if (argc > 2) {
+            stringstream bs(argv[2]);
+            string tok;
+            while (getline(bs, tok, ',')) {
+                if (tok.empty()) continue;
+                char *end = nullptr;
+                long long b = strtoll(tok.c_str(), &end, 10);
+                if (*end != '\0' || b < 0) {
+                    cout << "Usage: P2 isochrone <budget,budget,...> [zone ...]\n"
+                         << "Bad budget: " << tok << "\n";
+                    return 0;
+                }
+                budgets.push_back(b);
+            }
+        }
+        if (budgets.empty()) budgets = {5, 10, 15};
+        sort(budgets.begin(), budgets.end());
+
+        vector<int> facilities;
+        for (int i = 3; i < argc; i++) facilities.push_back(atoi(argv[i]));
+        if (argc <= 3) {
+            int z;
+            while (cin >> z) facilities.push_back(z);
+        }
+
+        SparseWorkspace ws;
+        vector<vector<int>> bands;
+        for (int src : facilities) {
+            if (src < 0 || src >= n) continue;
+            multiIsochrone(city, src, budgets, ws, bands);
+            for (size_t b = 0; b < budgets.size(); b++) {
+                cout << src << " <= " << budgets[b] << "min (" << bands[b].size() << "):";
+                for (int v : bands[b]) cout << " " << v;
+                cout << "\n";
+            }
+        }
+        return 0;
+    }
+
+    if (mode == "alternatives") {
+        int s = argc > 2 ? atoi(argv[2]) : -1, t = argc > 3 ? atoi(argv[3]) : -1;
+        int k = argc > 4 ? max(1, atoi(argv[4])) : 3;
+        if (s < 0 || s >= n || t < 0 || t >= n) {
+            cout << "Usage: P2 alternatives <source> <target> [k]\n";
+            return 0;
+        }
+        auto start = chrono::steady_clock::now();
+        AlternativeRouter router(city, t);
+        vector<Route> routes = router.routes(s, k);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        if (routes.empty()) cout << "No route.\n";
+        for (size_t i = 0; i < routes.size(); i++) {
+            cout << "Route " << i + 1 << " (" << routes[i].time << " min): ";
+            printPath(routes[i].path, names);
+        }
+        cerr << routes.size() << " routes in " << ms << " ms\n";
+        return 0;
+    }
+
+    if (mode == "tree") {
+        // tree file: .bin -> columnar binary, anything else -> CSV
+        int s = argc > 2 ? atoi(argv[2]) : -1;
+        if (s < 0 || s >= n) {
+            cout << "Usage: P2 tree <source> [file] [time|hops]\n";
+            return 0;
+        }
+        string file = argc > 3 ? argv[3] : "tree.csv";
+        bool hops = argc > 4 && string(argv[4]) == "hops";
+
+        ShortestPathTree tree;
+        tree.src = s;
+        if (hops) {
+            vector<int> hopDist;
+            bfsDirectionOptimizing(city, s, hopDist, tree.parent);
+            tree.dist.resize(n);
+            for (int v = 0; v < n; v++) tree.dist[v] = hopDist[v] == -1 ? INF : hopDist[v];
+        } else {
+            shortestTimeTable(city, s, tree.dist, tree.parent);
+        }
+
+        bool binary = file.size() >= 4 && file.substr(file.size() - 4) == ".bin";
+        bool ok = binary ? tree.writeBinary(file) : tree.writeCSV(file);
+        cout << (ok ? "Shortest-path tree written to " : "Could not write ") << file << "\n";
+        return 0;
+    }
+
+    if (mode == "path") {
+        ShortestPathTree tree;
+        int t = argc > 3 ? atoi(argv[3]) : -1;
+        if (argc < 4 || t < 0 || t >= n) {
+            cout << "Usage: P2 path <tree.bin> <target>\n";
+            return 0;
+        }
+        if (!tree.loadBinary(argv[2], n)) {
+            cout << argv[2] << " is not a shortest-path tree for this city\n";
+            return 0;
+        }
+        vector<int> path;
+        tree.pathTo(t, path);
+        if (path.empty()) {
+            cout << "unreachable\n";
+        } else {
+            cout << tree.dist[t] << " ";
+            printPath(path, names);
+        }
+        return 0;
+    }
+
+    if (mode == "route") {
+        int s = argc > 2 ? atoi(argv[2]) : -1, t = argc > 3 ? atoi(argv[3]) : -1;
+        if (s < 0 || s >= n || t < 0 || t >= n) {
+            cout << "Usage: P2 route <source> <target> [landmark file]\n";
+            return 0;
+        }
+        LandmarkRouter alt;
+        loadOrBuildALT(alt, 16, argc > 4 ? argv[4] : "roads.alt", false);
+
+        vector<int> path;
+        long long d = alt.query(city, s, t, path);
+        if (d == INF) {
+            cout << "Travel time: INF (unreachable)\n";
+        } else {
+            cout << "Travel time: " << d << " min\nPath: ";
+            printPath(path, names);
+        }
+
+        SearchWorkspace ws;
+        dijkstraShortestTime(city, s, ws, t);
+        long long early = ws.settled;
+        dijkstraShortestTime(city, s, ws);
+        cout << "\nZones settled:\n";
+        cout << left << setw(36) << "  Bidirectional A* (ALT)" << alt.settled << "\n";
+        cout << left << setw(36) << "  Dijkstra, stop at target" << early << "\n";
+        cout << left << setw(36) << "  Dijkstra, full table" << ws.settled << "\n";
+        if (ws.dist[t] != d) cout << "Time mismatch with Dijkstra ⚠\n";
+        return 0;
+    }
+
+    if (mode == "ch-build" || mode == "ch-check") {
+        ContractionHierarchy ch;
+        loadOrBuildCH(ch, argc > 2 ? argv[2] : "roads.ch", mode == "ch-build");
+        if (mode == "ch-build") return 0;
+
+        // up to ~200 evenly spaced sources, every target, against Dijkstra
+        SearchWorkspace ws;
+        vector<int> path;
+        long long mismatches = 0, pairs = 0;
+        for (int s = 0; s < n; s += max(1, n / 200)) {
+            dijkstraShortestTime(city, s, ws);
+            for (int t = 0; t < n; t++, pairs++) {
+                long long d = ch.query(s, t, path);
+                bool ok = d == ws.dist[t];
+                if (ok && d != INF) {
+                    long long len = 0;
+                    for (size_t i = 1; i < path.size(); i++) {
+                        long long hop = INF;
+                        for (auto &e : city.timeGraph[path[i - 1]])
+                            if (e.to == path[i]) hop = min(hop, (long long)e.timeCost);
+                        len += hop;
+                    }
+                    ok = path.front() == s && path.back() == t && len == d;
+                }
+                mismatches += !ok;
+            }
+        }
+        cout << "CH check: " << pairs << " pairs, " << mismatches << " mismatches\n";
+        return 0;
+    }
+
     cout << "CSV Loaded Successfully.\n";
     cout << "Total Zones: " << n << "\n\n";
 
@@ -248,7 +2531,7 @@ int main() {
     // Dijkstra
     vector<long long> distTime;
     vector<int> parentTime;
-    dijkstraShortestTime(city, src, distTime, parentTime);
+    shortestTimeTable(city, src, distTime, parentTime);
     printTimeTable(distTime, parentTime, names);
 
     // BFS
@@ -256,7 +2539,7 @@ int main() {
     int run; cin >> run;
     if (run == 1) {
         vector<int> dist, parent;
-        bfsUnweighted(city, src, dist, parent);
+        bfsDirectionOptimizing(city, src, dist, parent);
         printBFSTable(dist, parent, names);
     }
 
@@ -43,11 +43,11 @@ void printLaneTable(const vector<Lane> &lanes, int cycleTime) {
 }
 
 // ---------- Strategy 1: Proportional Allocation ---------- //
+// Works on flat arrays (queue, base, allocated for n lanes) so that the
+// single-junction planner and the network simulator share one rule.
 
-void allocateGreenProportional(vector<Lane> &lanes, int cycleTime) {
-    int n = (int)lanes.size();
-    if (n == 0) return;
-
+// Green for one of n lanes holding `queue` of the junction's totalQueue.
+double proportionalGreen(int queue, long long totalQueue, int n, int cycleTime) {
     double minSharePercent = 0.20; // 20% of cycle is reserved as equal base
     double basePool = cycleTime * minSharePercent;
     double extraPool = cycleTime - basePool;
@@ -57,28 +57,34 @@ void allocateGreenProportional(vector<Lane> &lanes, int cycleTime) {
         basePool = cycleTime;
     }
 
-    double equalBase = basePool / n;
-    for (auto &ln : lanes) {
-        ln.baseGreen = equalBase;
-        ln.allocatedGreen = equalBase;
-    }
+    if (totalQueue == 0) return (double)cycleTime / n;
+    double fraction = (double)queue / (double)totalQueue;
+    return basePool / n + extraPool * fraction;
+}
+
+void allocateProportionalFlat(const int *queue, double *base, double *alloc,
+                              int n, int cycleTime) {
+    if (n == 0) return;
 
     long long totalQueue = 0;
-    for (auto &ln : lanes) totalQueue += ln.queueLength;
+    for (int i = 0; i < n; i++) totalQueue += queue[i];
 
-    if (totalQueue == 0) {
-        double share = (double)cycleTime / n;
-        for (auto &ln : lanes) {
-            ln.baseGreen = share;
-            ln.allocatedGreen = share;
-        }
-        return;
+    double equalBase = proportionalGreen(0, totalQueue, n, cycleTime);
+    for (int i = 0; i < n; i++) {
+        base[i] = equalBase;
+        alloc[i] = proportionalGreen(queue[i], totalQueue, n, cycleTime);
     }
+}
 
-    for (auto &ln : lanes) {
-        double fraction = (double)ln.queueLength / (double)totalQueue;
-        double extra = extraPool * fraction;
-        ln.allocatedGreen += extra;
+void allocateGreenProportional(vector<Lane> &lanes, int cycleTime) {
+    int n = (int)lanes.size();
+    vector<int> queue(n);
+    vector<double> base(n), alloc(n);
+    for (int i = 0; i < n; i++) queue[i] = lanes[i].queueLength;
+    allocateProportionalFlat(queue.data(), base.data(), alloc.data(), n, cycleTime);
+    for (int i = 0; i < n; i++) {
+        lanes[i].baseGreen = base[i];
+        lanes[i].allocatedGreen = alloc[i];
     }
 }
 
@@ -125,6 +131,72 @@ void adjustUsingPriorityQueue(vector<Lane> &lanes, int cycleTime) {
     }
 }
 
+// ---------- Strategy 2b: Water-Filling (exact priority split) ---------- //
+// Same split as the chunked heap without the chunks. Each chunk of
+// secondsPerVehicle goes to the lane with the largest effective queue and
+// lowers it by one, so the heap drains all lanes down to a common level L:
+// lane i ends with secondsPerVehicle * max(0, queue_i - L) extra seconds.
+// Sorting queues once and scanning prefix sums finds L in O(n log n),
+// independent of the cycle length. Tied lanes share evenly instead of one
+// chunk going to whichever the heap pops first, so each lane is within one
+// chunk of the heap's result. Once every effective queue is 0 the heap
+// keeps cycling through the tied lanes that still have vehicles; here that
+// leftover is split evenly between them. (The 1000-step cap is not applied.)
+
+void waterFillFlat(const int *queue, double *alloc, int n, int cycleTime,
+                   double secondsPerVehicle, vector<int> &sorted) {
+    if (n == 0) return;
+
+    double totalAllocated = 0.0;
+    for (int i = 0; i < n; i++) totalAllocated += alloc[i];
+
+    double eps = 1e-6;
+    double remaining = (double)cycleTime - totalAllocated;
+    if (remaining <= eps) return;
+
+    sorted.resize(n);
+    for (int i = 0; i < n; i++) sorted[i] = max(0, queue[i]);
+    sort(sorted.begin(), sorted.end(), greater<int>());
+
+    // With the k heaviest lanes active, draining `need` vehicles of priority
+    // leaves them at (prefix - need) / k; valid once that is >= the next lane.
+    double need = remaining / secondsPerVehicle;
+    double level = 0.0, prefix = 0.0;
+    for (int k = 0; k < n; k++) {
+        prefix += sorted[k];
+        double next = k + 1 < n ? sorted[k + 1] : 0.0;
+        double L = (prefix - need) / (k + 1);
+        if (L >= next) {
+            level = L;
+            break;
+        }
+    }
+
+    int waiting = 0;
+    for (int i = 0; i < n; i++) {
+        double add = secondsPerVehicle * max(0.0, queue[i] - level);
+        alloc[i] += add;
+        remaining -= add;
+        if (queue[i] > 0) waiting++;
+    }
+    if (remaining > eps && waiting > 0)
+        for (int i = 0; i < n; i++)
+            if (queue[i] > 0) alloc[i] += remaining / waiting;
+}
+
+void allocateWaterFilling(vector<Lane> &lanes, int cycleTime,
+                          double secondsPerVehicle = 2.0) {
+    int n = (int)lanes.size();
+    vector<int> queue(n), sorted;
+    vector<double> alloc(n);
+    for (int i = 0; i < n; i++) {
+        queue[i] = lanes[i].queueLength;
+        alloc[i] = lanes[i].allocatedGreen;
+    }
+    waterFillFlat(queue.data(), alloc.data(), n, cycleTime, secondsPerVehicle, sorted);
+    for (int i = 0; i < n; i++) lanes[i].allocatedGreen = alloc[i];
+}
+
 // ---------- Simple Simulation over Multiple Cycles ---------- //
 
 void simulateMultipleCycles(vector<Lane> lanes,
@@ -161,6 +233,813 @@ void simulateMultipleCycles(vector<Lane> lanes,
     }
 }
 
+// ---------- Streaming Controller (detector feed) ---------- //
+// Detector records "timestamp,lane,queue" arrive one per line. A record only
+// touches its own lane: the live queue and the running total are updated and
+// the lane is queued as dirty (O(1) with the name index). At each cycle
+// boundary the plan snapshot takes over only the dirty lanes' queues and the
+// running total (O(dirty)); each lane's green is then proportionalGreen of
+// its snapshot queue, computed as the plan is printed. The proportional
+// split already uses the whole cycle, so the priority / water-filling step
+// would add nothing here. Boundaries are crossed either by a record's
+// timestamp or, on a quiet feed, by the wall clock (feed time is taken to
+// advance in real time from the last record). The time to apply each record
+// and to emit each plan is recorded against a latency budget.
+
+class StreamingController {
+    vector<string> names;
+    unordered_map<string, int> index;
+    vector<int> queue;             // live readings
+    long long liveTotal = 0;
+    vector<int> planQueue;         // snapshot the current plan was built from
+    long long planTotal = 0;
+    int planLanes = 0;
+    vector<int> dirtyList;
+    vector<char> dirty;
+
+public:
+    int cycleTime;
+    long long recomputes = 0, reused = 0;
+
+    StreamingController(const vector<Lane> &initial, int cycle) : cycleTime(cycle) {
+        for (auto &ln : initial) addLane(ln.name, ln.queueLength);
+    }
+
+    int planLaneCount() const { return planLanes; }
+    const string &laneName(int i) const { return names[i]; }
+    double green(int i) const {
+        return proportionalGreen(planQueue[i], planTotal, planLanes, cycleTime);
+    }
+
+    int addLane(const string &name, int q) {
+        int id = (int)names.size();
+        index[name] = id;
+        names.push_back(name);
+        queue.push_back(max(0, q));
+        liveTotal += queue.back();
+        planQueue.push_back(0);
+        dirty.push_back(1);
+        dirtyList.push_back(id);
+        return id;
+    }
+
+    void update(const string &name, int q) {
+        auto it = index.find(name);
+        if (it == index.end()) {
+            addLane(name, q);
+            return;
+        }
+        int id = it->second;
+        q = max(0, q);
+        if (queue[id] == q) return;
+        liveTotal += q - queue[id];
+        queue[id] = q;
+        if (!dirty[id]) {
+            dirty[id] = 1;
+            dirtyList.push_back(id);
+        }
+    }
+
+    // Moves the plan snapshot to the live readings: O(dirty lanes).
+    void nextPlan() {
+        if (dirtyList.empty()) {
+            reused++;
+            return;
+        }
+        for (int id : dirtyList) {
+            planQueue[id] = queue[id];
+            dirty[id] = 0;
+        }
+        dirtyList.clear();
+        planTotal = liveTotal;
+        planLanes = (int)names.size();
+        recomputes++;
+    }
+};
+
+// Latencies of the most recent samples (bounded memory for long runs),
+// plus count and worst case over the whole run.
+struct LatencyWindow {
+    vector<double> recent;
+    size_t next = 0;
+    long long count = 0;
+    double worst = 0;
+
+    void add(double us) {
+        if (recent.size() < 65536) recent.push_back(us);
+        else recent[next++ % recent.size()] = us;
+        count++;
+        worst = max(worst, us);
+    }
+
+    double percentile(double p) const {
+        if (recent.empty()) return 0.0;
+        vector<double> v = recent;
+        size_t k = min(v.size() - 1, (size_t)(p * v.size()));
+        nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    }
+};
+
+// Reads records until end of input; with follow = true, waits for more
+// lines at end of file like `tail -f` and reports stats every 60 plans.
+void runStreamingController(istream &in, bool follow, const vector<Lane> &initial,
+                            int cycleTime, double budgetUs) {
+    StreamingController ctl(initial, cycleTime);
+    LatencyWindow updateUs, planUs;
+    long long badRecords = 0, budgetMisses = 0;
+    double nextBoundary = -1, lastTs = 0;
+    string line, planLine;
+
+    auto reportStats = [&]() {
+        cerr << fixed << setprecision(2)
+             << "Records: " << updateUs.count << " (bad " << badRecords << ")"
+             << "  update p50 " << updateUs.percentile(0.50) << " us  p99 "
+             << updateUs.percentile(0.99) << " us  max " << updateUs.worst << " us\n"
+             << "Plans: " << planUs.count << " (" << ctl.recomputes << " recomputed, "
+             << ctl.reused << " reused)  p50 " << planUs.percentile(0.50) << " us  p99 "
+             << planUs.percentile(0.99) << " us  max " << planUs.worst << " us  over "
+             << budgetUs << " us budget: " << budgetMisses << "\n";
+    };
+
+    auto emitPlan = [&](double cycleStart) {
+        auto start = chrono::steady_clock::now();
+        ctl.nextPlan();
+        planLine = "plan " + to_string((long long)cycleStart);
+        char green[32];
+        for (int i = 0; i < ctl.planLaneCount(); i++) {
+            snprintf(green, sizeof(green), "=%.1f", ctl.green(i));
+            planLine += ' ';
+            planLine += ctl.laneName(i);
+            planLine += green;
+        }
+        planLine += '\n';
+        cout << planLine << flush;
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        planUs.add(us);
+        if (us > budgetUs) budgetMisses++;
+        if (follow && planUs.count % 60 == 0) reportStats(); // no end of input
+    };
+
+    // Lines are read on their own thread so that a quiet feed cannot hold
+    // back the plan: the loop below waits for input or the next boundary.
+    mutex m;
+    condition_variable cv;
+    deque<string> incoming, batch;
+    bool ended = false;
+    thread reader([&]() {
+        string text, pending;
+        while (true) {
+            // In follow mode a line without its '\n' may still be being
+            // written: keep it and join it with what the next read returns.
+            bool got = (bool)getline(in, text);
+            if (got && follow && in.eof()) {
+                pending += text;
+                got = false;
+            }
+            if (!got) {
+                if (!follow) break;
+                in.clear();
+                this_thread::sleep_for(chrono::milliseconds(50));
+                continue;
+            }
+            if (!pending.empty()) {
+                text = pending + text;
+                pending.clear();
+            }
+            lock_guard<mutex> lock(m);
+            incoming.push_back(move(text));
+            cv.notify_one();
+        }
+        lock_guard<mutex> lock(m);
+        ended = true;
+        cv.notify_one();
+    });
+
+    // the feed clock read feedTs at wall time feedWall
+    double feedTs = 0;
+    auto feedWall = chrono::steady_clock::now();
+
+    while (true) {
+        if (batch.empty()) {
+            unique_lock<mutex> lock(m);
+            auto ready = [&] { return !incoming.empty() || ended; };
+            if (nextBoundary >= 0) {
+                auto due = feedWall + chrono::duration_cast<chrono::steady_clock::duration>(
+                                          chrono::duration<double>(nextBoundary - feedTs));
+                if (!cv.wait_until(lock, due, ready)) {
+                    lock.unlock();
+                    emitPlan(nextBoundary); // quiet feed: the timer crosses the boundary
+                    feedTs = nextBoundary;
+                    feedWall = due;
+                    nextBoundary += cycleTime;
+                    continue;
+                }
+            } else {
+                cv.wait(lock, ready);
+            }
+            if (incoming.empty()) break; // ended
+            swap(batch, incoming);
+        }
+        line = move(batch.front());
+        batch.pop_front();
+        if (line.empty() || (!isdigit((unsigned char)line[0]) && line[0] != '-')) continue; // header / blank
+
+        auto start = chrono::steady_clock::now();
+        size_t c1 = line.find(','), c2 = line.find(',', c1 + 1);
+        if (c1 == string::npos || c2 == string::npos) { badRecords++; continue; }
+        double ts;
+        int queue;
+        try {
+            ts = stod(line.substr(0, c1));
+            queue = stoi(line.substr(c2 + 1));
+        } catch (...) {
+            badRecords++;
+            continue;
+        }
+
+        if (ts < 0 || ts < lastTs) { badRecords++; continue; } // clock went backwards
+        lastTs = feedTs = ts;
+        feedWall = chrono::steady_clock::now();
+
+        // One plan when this record passes the boundary, however many cycles
+        // the feed skipped; the next boundary is the first one after ts.
+        if (nextBoundary < 0) nextBoundary = floor(ts / cycleTime) * cycleTime + cycleTime;
+        if (ts >= nextBoundary) {
+            emitPlan(nextBoundary);
+            nextBoundary = ts - fmod(ts - nextBoundary, cycleTime) + cycleTime;
+            start = chrono::steady_clock::now(); // plan time is tracked separately
+        }
+
+        ctl.update(line.substr(c1 + 1, c2 - c1 - 1), queue);
+        updateUs.add(chrono::duration<double, micro>(
+            chrono::steady_clock::now() - start).count());
+    }
+
+    reader.join();
+    reportStats();
+}
+
+// ---------- Monte Carlo Evaluation (stochastic arrivals) ---------- //
+// A fixed plan is replayed against many random arrival sequences. Lanes
+// do not interact under a fixed plan, so each lane is run on its own with
+// all replications side by side in flat arrays: every step of a cycle is
+// one branch-free loop over the batch (RNG, arrival sampling, queue
+// update), which the compiler can vectorise. RNG is one xorshift32 state
+// per replication. Poisson counts come from inverting a per-lane CDF table
+// with a fixed-length branchless binary search; platoon arrivals are
+// Poisson platoons of a fixed size. Queues are fluid (green × discharge
+// vehicles leave per cycle, fractions included) and delay per lane-cycle
+// is (queue at start + queue at end) / 2 × cycle.
+
+struct PoissonTable {
+    vector<float> cdf; // size is a power of two, last entry 1
+    int steps = 0;
+
+    explicit PoissonTable(double mean) {
+        int size = 1;
+        while (size < mean + 10 * sqrt(mean) + 10) size *= 2;
+        cdf.resize(size);
+        double p = exp(-mean), F = 0;
+        for (int k = 0; k < size; k++) {
+            F += p;
+            cdf[k] = (float)min(F, 1.0);
+            p *= mean / (k + 1);
+        }
+        cdf[size - 1] = 1.0f;
+        steps = __builtin_ctz(size);
+    }
+};
+
+struct LaneMonteCarloStats {
+    double queueP50, queueP95, queueP99; // end-of-cycle queue over all lane-cycles
+    double delayP50, delayP95;           // mean delay per vehicle (s) over replications
+};
+
+struct MonteCarloResult {
+    vector<LaneMonteCarloStats> lanes;
+    double networkDelayP50, networkDelayP95, networkDelayP99;
+    long long laneCycles = 0;
+    double seconds = 0;
+};
+
+static double histogramPercentile(const vector<uint32_t> &hist, long long total, double p) {
+    long long want = (long long)ceil(p * total), seen = 0;
+    for (size_t q = 0; q < hist.size(); q++) {
+        seen += hist[q];
+        if (seen >= want) return (double)q;
+    }
+    return (double)hist.size() - 1;
+}
+
+static double valuePercentile(vector<double> v, double p) {
+    if (v.empty()) return 0;
+    size_t k = min(v.size() - 1, (size_t)(p * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+MonteCarloResult evaluatePlanMonteCarlo(const vector<Lane> &plan,
+                                        const vector<double> &arrivalsPerCycle,
+                                        int cycleTime, int dischargeRatePerSec,
+                                        int replications, int cycles,
+                                        int platoonSize, uint32_t seed) {
+    const int R = replications;
+    const int HIST = 4096;
+    MonteCarloResult result;
+    vector<double> networkDelay(R, 0.0), networkArrived(R, 0.0);
+
+    vector<uint32_t> state(R);
+    vector<int32_t> pos(R);
+    vector<float> queue(R), u(R), delaySum(R), arrivedSum(R);
+    vector<uint32_t> hist(HIST);
+
+    auto start = chrono::steady_clock::now();
+    for (size_t li = 0; li < plan.size(); li++) {
+        const float capacity = (float)(plan[li].allocatedGreen * dischargeRatePerSec);
+        const int32_t batch = max(1, platoonSize);
+        PoissonTable table(arrivalsPerCycle[li] / batch);
+        const float *cdf = table.cdf.data();
+
+        for (int r = 0; r < R; r++) {
+            uint32_t x = seed ^ (uint32_t)(li * 0x9E3779B9u) ^ (uint32_t)(r * 0x85EBCA6Bu);
+            state[r] = x ? x : 1;
+            queue[r] = plan[li].queueLength;
+        }
+        fill(delaySum.begin(), delaySum.end(), 0.0f);
+        fill(arrivedSum.begin(), arrivedSum.end(), 0.0f);
+        fill(hist.begin(), hist.end(), 0u);
+
+        for (int c = 0; c < cycles; c++) {
+            for (int r = 0; r < R; r++) {
+                uint32_t x = state[r];
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                state[r] = x;
+                u[r] = (x >> 8) * (1.0f / 16777216.0f);
+                pos[r] = 0;
+            }
+            for (int s = table.steps - 1; s >= 0; s--) {
+                int32_t half = 1 << s;
+                for (int r = 0; r < R; r++)
+                    pos[r] += (cdf[pos[r] + half - 1] < u[r]) ? half : 0;
+            }
+            for (int r = 0; r < R; r++) {
+                float a = (float)(pos[r] * batch);
+                float q0 = queue[r];
+                float q1 = max(q0 - capacity, 0.0f) + a;
+                queue[r] = q1;
+                delaySum[r] += 0.5f * (q0 + q1) * cycleTime;
+                arrivedSum[r] += a;
+            }
+            for (int r = 0; r < R; r++) hist[min((int)queue[r], HIST - 1)]++;
+        }
+
+        long long total = (long long)R * cycles;
+        vector<double> perRep(R);
+        for (int r = 0; r < R; r++) {
+            perRep[r] = delaySum[r] / max(1.0f, arrivedSum[r]);
+            networkDelay[r] += delaySum[r];
+            networkArrived[r] += arrivedSum[r];
+        }
+        result.lanes.push_back({histogramPercentile(hist, total, 0.50),
+                                histogramPercentile(hist, total, 0.95),
+                                histogramPercentile(hist, total, 0.99),
+                                valuePercentile(perRep, 0.50),
+                                valuePercentile(perRep, 0.95)});
+        result.laneCycles += total;
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> perRep(R);
+    for (int r = 0; r < R; r++) perRep[r] = networkDelay[r] / max(1.0, networkArrived[r]);
+    result.networkDelayP50 = valuePercentile(perRep, 0.50);
+    result.networkDelayP95 = valuePercentile(perRep, 0.95);
+    result.networkDelayP99 = valuePercentile(perRep, 0.99);
+    return result;
+}
+
+void printMonteCarloReport(const string &title, const vector<Lane> &plan,
+                           const vector<double> &arrivalsPerCycle,
+                           const MonteCarloResult &res) {
+    cout.setf(ios::fixed);
+    cout << setprecision(1);
+    cout << "\n=== " << title << " ===\n\n";
+    cout << left << setw(18) << "Lane" << setw(9) << "Green" << setw(10) << "Arr/cyc"
+         << setw(8) << "Q p50" << setw(8) << "Q p95" << setw(8) << "Q p99"
+         << setw(12) << "Delay p50" << "Delay p95 (s/veh)\n";
+    cout << string(90, '-') << "\n";
+    for (size_t i = 0; i < plan.size(); i++) {
+        const auto &s = res.lanes[i];
+        cout << left << setw(18) << plan[i].name << setw(9) << plan[i].allocatedGreen
+             << setw(10) << arrivalsPerCycle[i]
+             << setw(8) << s.queueP50 << setw(8) << s.queueP95 << setw(8) << s.queueP99
+             << setw(12) << s.delayP50 << s.delayP95 << "\n";
+    }
+    cout << "\nNetwork delay per vehicle (s): p50 " << res.networkDelayP50
+         << "  p95 " << res.networkDelayP95 << "  p99 " << res.networkDelayP99 << "\n";
+    cout << setprecision(2) << "Lane-cycles: " << res.laneCycles << " in " << res.seconds
+         << " s (" << res.laneCycles / max(res.seconds, 1e-9) / 1e6 << " M/s)\n";
+}
+
+// ---------- Network-wide Simulation (many junctions) ---------- //
+// Lanes of every junction live in flat arrays (structure of arrays), and
+// junction j owns lanes [laneStart[j], laneStart[j+1]). Lane names are
+// interned once, so a cycle touches only numbers. Junctions never interact,
+// so each thread owns a block of junctions for the whole horizon and keeps
+// its own per-hour totals; they are summed at the end.
+
+struct NameTable {
+    vector<string> names;
+    unordered_map<string, int> ids;
+
+    int intern(const string &name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        ids.emplace(name, (int)names.size());
+        names.push_back(name);
+        return (int)names.size() - 1;
+    }
+};
+
+struct JunctionNetwork {
+    vector<int> laneStart = {0};
+    vector<int> nameId;
+    vector<int> queue;            // vehicles waiting
+    vector<double> arrivalRate;   // vehicles per second
+    vector<double> baseGreen;     // seconds, last planned cycle
+    vector<double> allocatedGreen;
+    NameTable names;
+
+    int junctions() const { return (int)laneStart.size() - 1; }
+    int lanes() const { return (int)queue.size(); }
+
+    void addLane(const string &name, int q, double rate) {
+        nameId.push_back(names.intern(name));
+        queue.push_back(max(0, q));
+        arrivalRate.push_back(max(0.0, rate));
+        baseGreen.push_back(0.0);
+        allocatedGreen.push_back(0.0);
+    }
+
+    void closeJunction() {
+        if (lanes() > laneStart.back()) laneStart.push_back(lanes());
+    }
+};
+
+// Proportional split plus water-filling for lanes [a, b), through the same
+// flat-array functions as allocateGreenProportional / allocateWaterFilling.
+void planJunction(JunctionNetwork &net, int a, int b, int cycleTime,
+                  vector<int> &scratch) {
+    int n = b - a;
+    if (n <= 0) return;
+    allocateProportionalFlat(&net.queue[a], &net.baseGreen[a], &net.allocatedGreen[a],
+                             n, cycleTime);
+    waterFillFlat(&net.queue[a], &net.allocatedGreen[a], n, cycleTime, 2.0, scratch);
+}
+
+struct HourStats {
+    long long laneCycles = 0;
+    long long arrived = 0, served = 0;
+    double queueSum = 0;   // summed over lane-cycles, end of cycle
+    int maxQueue = 0;
+    long long saturated = 0; // lane-cycles that could not clear their queue
+
+    void add(const HourStats &o) {
+        laneCycles += o.laneCycles;
+        arrived += o.arrived;
+        served += o.served;
+        queueSum += o.queueSum;
+        maxQueue = max(maxQueue, o.maxQueue);
+        saturated += o.saturated;
+    }
+};
+
+// Advances every junction through `hours` of fixed-length cycles. Each
+// cycle: plan from current queues, discharge during green, add arrivals.
+// Arrivals are deterministic (rate × time, carried exactly across cycles).
+vector<HourStats> simulateNetwork(JunctionNetwork &net, int cycleTime,
+                                  double dischargeRatePerSec, int hours, int threads) {
+    // Every cycle that starts inside the horizon runs, and is counted in the
+    // hour it starts in, so cycle lengths that do not divide 3600 lose nothing.
+    long long horizon = 3600LL * hours;
+    long long cycles = (horizon + cycleTime - 1) / cycleTime;
+    int J = net.junctions();
+    threads = max(1, min(threads, max(1, J)));
+
+    // Split junctions into blocks of roughly equal lane count.
+    vector<int> blockStart = {0};
+    for (int t = 1; t < threads; t++) {
+        long long target = (long long)net.lanes() * t / threads;
+        int j = upper_bound(net.laneStart.begin(), net.laneStart.end(), target)
+                - net.laneStart.begin() - 1;
+        blockStart.push_back(max(blockStart.back(), min(j, J)));
+    }
+    blockStart.push_back(J);
+
+    vector<vector<HourStats>> perThread(threads, vector<HourStats>(hours));
+    auto worker = [&](int t) {
+        vector<int> scratch;
+        vector<HourStats> &stats = perThread[t];
+        for (long long c = 0; c < cycles; c++) {
+            HourStats &h = stats[c * cycleTime / 3600];
+            double t0 = (double)c * cycleTime, t1 = t0 + cycleTime;
+            for (int j = blockStart[t]; j < blockStart[t + 1]; j++) {
+                int a = net.laneStart[j], b = net.laneStart[j + 1];
+                planJunction(net, a, b, cycleTime, scratch);
+                for (int i = a; i < b; i++) {
+                    int capacity = (int)(net.allocatedGreen[i] * dischargeRatePerSec);
+                    int served = min(net.queue[i], capacity);
+                    int arrived = (int)(floor(t1 * net.arrivalRate[i]) -
+                                        floor(t0 * net.arrivalRate[i]));
+                    if (served < net.queue[i]) h.saturated++;
+                    net.queue[i] += arrived - served;
+                    h.served += served;
+                    h.arrived += arrived;
+                    h.queueSum += net.queue[i];
+                    h.maxQueue = max(h.maxQueue, net.queue[i]);
+                }
+                h.laneCycles += b - a;
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &th : pool) th.join();
+
+    vector<HourStats> total(hours);
+    for (auto &stats : perThread)
+        for (int h = 0; h < hours; h++) total[h].add(stats[h]);
+    return total;
+}
+
+// Synthetic city: 3-8 approach lanes per junction, names from a small set,
+// arrival rates 0.01-0.08 vehicles per second (busy but mostly undersaturated).
+JunctionNetwork buildSyntheticNetwork(int junctions, unsigned seed = 7) {
+    static const vector<string> approach = {
+        "North", "East", "South", "West", "NorthEast", "SouthWest", "NorthWest", "SouthEast"};
+    JunctionNetwork net;
+    mt19937 rng(seed);
+    for (int j = 0; j < junctions; j++) {
+        int lanes = 3 + rng() % 6;
+        for (int i = 0; i < lanes; i++)
+            net.addLane(approach[i], rng() % 40, 0.01 + (rng() % 1000) / 14000.0);
+        net.closeJunction();
+    }
+    return net;
+}
+
+void printNetworkReport(const JunctionNetwork &net, const vector<HourStats> &stats,
+                        int cycleTime, int threads, double seconds) {
+    cout.setf(ios::fixed);
+    cout << setprecision(2);
+    cout << "\n=== Network simulation: " << net.junctions() << " junctions, "
+         << net.lanes() << " lanes, " << net.names.names.size() << " lane names, cycle "
+         << cycleTime << " s ===\n\n";
+    cout << left << setw(6) << "Hour" << setw(14) << "Arrived" << setw(14) << "Served"
+         << setw(14) << "Avg Queue" << setw(12) << "Max Queue" << "Saturated %\n";
+    cout << string(70, '-') << "\n";
+
+    HourStats all;
+    for (size_t h = 0; h < stats.size(); h++) {
+        const HourStats &s = stats[h];
+        all.add(s);
+        cout << left << setw(6) << h << setw(14) << s.arrived << setw(14) << s.served
+             << setw(14) << s.queueSum / max(1LL, s.laneCycles) << setw(12) << s.maxQueue
+             << 100.0 * s.saturated / max(1LL, s.laneCycles) << "\n";
+    }
+    cout << string(70, '-') << "\n";
+    cout << left << setw(6) << "All" << setw(14) << all.arrived << setw(14) << all.served
+         << setw(14) << all.queueSum / max(1LL, all.laneCycles) << setw(12) << all.maxQueue
+         << 100.0 * all.saturated / max(1LL, all.laneCycles) << "\n\n";
+    cout << "Lane-cycles: " << all.laneCycles << "  Threads: " << threads
+         << "  Time: " << seconds << " s  ("
+         << all.laneCycles / max(seconds, 1e-9) / 1e6 << " M lane-cycles/s)\n";
+}
+
+// ---------- Corridor Green-Wave Optimizer ---------- //
+// An arterial is a chain of junctions with a travel time between
+// neighbours. At a common cycle C each junction's lanes are planned as usual
+// (proportional + heap) and, lanes being served in order, the outbound and
+// inbound arterial lanes each get a green window inside the cycle. Junction
+// j runs shifted by offset o_j. Seen from junction 0, a car leaving in
+// outbound green at time t meets junction j at t + T_j, so the outbound
+// band is the longest stretch of junction 0's window that survives
+// intersecting with every [o_j + start_j - T_j, + green_j) mod C (inbound
+// the same with + T_j). The score is the MAXBAND efficiency
+// (outbound band + inbound band) / 2C.
+//
+// Offsets are fixed junction by junction in steps of `step` seconds. The
+// bands can only shrink as junctions are added, so the current bands (capped
+// by the smallest remaining green) bound every completion: branches that
+// cannot beat the best plan so far are cut. Offsets that leave the same
+// bands are the same branch and are explored once. Work is split into
+// (cycle, first offset) tasks shared by threads, with one shared best.
+
+struct CorridorJunction {
+    string name;
+    double travel = 0;      // seconds from the previous junction
+    vector<Lane> lanes;
+    int outLane = -1, inLane = -1;
+};
+
+struct CorridorPlan {
+    int cycle = 0;
+    vector<double> offsets;
+    double efficiency = -1, outBand = 0, inBand = 0;
+};
+
+class CorridorOptimizer {
+    using Band = vector<pair<double, double>>; // disjoint [begin, end) pieces
+
+    struct Windows {
+        int cycle;
+        vector<double> T, outStart, outGreen, inStart, inGreen;
+        vector<double> outMinAfter, inMinAfter; // smallest green from j on
+    };
+
+    const vector<CorridorJunction> &corridor;
+    double step;
+    mutex bestLock;
+    atomic<double> bestScore{-1};
+    CorridorPlan best;
+    atomic<long long> nodes{0};
+
+    Windows windowsFor(int cycle) const {
+        int J = corridor.size();
+        Windows w;
+        w.cycle = cycle;
+        w.T.assign(J, 0);
+        w.outStart.assign(J, 0);
+        w.outGreen.assign(J, cycle);
+        w.inStart.assign(J, 0);
+        w.inGreen.assign(J, cycle);
+        for (int j = 0; j < J; j++) {
+            if (j > 0) w.T[j] = w.T[j - 1] + corridor[j].travel;
+            vector<Lane> plan = corridor[j].lanes;
+            allocateGreenProportional(plan, cycle);
+            adjustUsingPriorityQueue(plan, cycle);
+            double start = 0;
+            for (int i = 0; i < (int)plan.size(); i++) {
+                if (i == corridor[j].outLane) { w.outStart[j] = start; w.outGreen[j] = plan[i].allocatedGreen; }
+                if (i == corridor[j].inLane) { w.inStart[j] = start; w.inGreen[j] = plan[i].allocatedGreen; }
+                start += plan[i].allocatedGreen;
+            }
+        }
+        w.outMinAfter.assign(J + 1, cycle);
+        w.inMinAfter.assign(J + 1, cycle);
+        for (int j = J - 1; j >= 0; j--) {
+            w.outMinAfter[j] = min(w.outMinAfter[j + 1], w.outGreen[j]);
+            w.inMinAfter[j] = min(w.inMinAfter[j + 1], w.inGreen[j]);
+        }
+        return w;
+    }
+
+    static void intersectArc(const Band &band, double a, double green, double cycle, Band &out) {
+        out.clear();
+        if (green >= cycle) { out = band; return; }
+        a = fmod(a, cycle);
+        if (a < 0) a += cycle;
+        pair<double, double> arcs[2] = {{a, min(a + green, cycle)}, {0, a + green - cycle}};
+        for (auto &piece : band)
+            for (auto &arc : arcs) {
+                double lo = max(piece.first, arc.first), hi = min(piece.second, arc.second);
+                if (hi - lo > 1e-9) out.push_back({lo, hi});
+            }
+        sort(out.begin(), out.end());
+    }
+
+    static double longest(const Band &band) {
+        double len = 0;
+        for (auto &piece : band) len = max(len, piece.second - piece.first);
+        return len;
+    }
+
+    double bound(const Windows &w, int j, const Band &out, const Band &in) const {
+        return (min(longest(out), w.outMinAfter[j]) + min(longest(in), w.inMinAfter[j]))
+               / (2.0 * w.cycle);
+    }
+
+    void offerBest(const Windows &w, const vector<double> &offsets, const Band &out, const Band &in) {
+        double score = (longest(out) + longest(in)) / (2.0 * w.cycle);
+        lock_guard<mutex> lock(bestLock);
+        if (score <= best.efficiency) return;
+        best = {w.cycle, offsets, score, longest(out), longest(in)};
+        bestScore.store(score);
+    }
+
+    void search(const Windows &w, int j, const Band &out, const Band &in, vector<double> &offsets) {
+        nodes++;
+        int J = corridor.size();
+        if (j == J) {
+            offerBest(w, offsets, out, in);
+            return;
+        }
+
+        struct Child { double bound, offset; Band out, in; };
+        vector<Child> children;
+        Band nextOut, nextIn;
+        for (double o = 0; o < w.cycle - 1e-9; o += step) {
+            intersectArc(out, o + w.outStart[j] - w.T[j], w.outGreen[j], w.cycle, nextOut);
+            intersectArc(in, o + w.inStart[j] + w.T[j], w.inGreen[j], w.cycle, nextIn);
+            double b = bound(w, j + 1, nextOut, nextIn);
+            if (b <= bestScore.load() + 1e-12) continue;
+            bool same = false;
+            for (auto &c : children)
+                if (c.out == nextOut && c.in == nextIn) { same = true; break; }
+            if (!same) children.push_back({b, o, nextOut, nextIn});
+        }
+        sort(children.begin(), children.end(),
+             [](const Child &a, const Child &b) { return a.bound > b.bound; });
+
+        for (auto &c : children) {
+            if (c.bound <= bestScore.load() + 1e-12) break;
+            offsets[j] = c.offset;
+            search(w, j + 1, c.out, c.in, offsets);
+        }
+    }
+
+public:
+    CorridorOptimizer(const vector<CorridorJunction> &c, double offsetStep)
+        : corridor(c), step(max(0.5, offsetStep)) {}
+
+    long long nodesExplored() const { return nodes.load(); }
+
+    CorridorPlan optimize(int cycleMin, int cycleMax, int cycleStep, int threads) {
+        vector<Windows> windows;
+        for (int c = cycleMin; c <= cycleMax; c += max(1, cycleStep)) windows.push_back(windowsFor(c));
+
+        // Seed with the plain outbound green wave (o_j = T_j) at each cycle.
+        for (auto &w : windows) {
+            Band out = {{w.outStart[0], w.outStart[0] + w.outGreen[0]}};
+            Band in = {{w.inStart[0], w.inStart[0] + w.inGreen[0]}}, tmpOut, tmpIn;
+            vector<double> offsets(corridor.size(), 0);
+            for (size_t j = 1; j < corridor.size(); j++) {
+                offsets[j] = fmod(round((w.T[j] + w.outStart[0] - w.outStart[j]) / step) * step, w.cycle);
+                if (offsets[j] < 0) offsets[j] += w.cycle;
+                intersectArc(out, offsets[j] + w.outStart[j] - w.T[j], w.outGreen[j], w.cycle, tmpOut);
+                intersectArc(in, offsets[j] + w.inStart[j] + w.T[j], w.inGreen[j], w.cycle, tmpIn);
+                out.swap(tmpOut);
+                in.swap(tmpIn);
+            }
+            offerBest(w, offsets, out, in);
+        }
+
+        // Tasks: (cycle, offset of junction 1), richest cycles first.
+        vector<pair<int, double>> tasks;
+        for (int ci = (int)windows.size() - 1; ci >= 0; ci--)
+            for (double o = 0; o < windows[ci].cycle - 1e-9; o += step) tasks.push_back({ci, o});
+
+        atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t t; (t = next.fetch_add(1)) < tasks.size();) {
+                const Windows &w = windows[tasks[t].first];
+                vector<double> offsets(corridor.size(), 0);
+                Band out = {{w.outStart[0], w.outStart[0] + w.outGreen[0]}};
+                Band in = {{w.inStart[0], w.inStart[0] + w.inGreen[0]}};
+                if (corridor.size() == 1) {
+                    offerBest(w, offsets, out, in);
+                    continue;
+                }
+                Band out1, in1;
+                double o = tasks[t].second;
+                intersectArc(out, o + w.outStart[1] - w.T[1], w.outGreen[1], w.cycle, out1);
+                intersectArc(in, o + w.inStart[1] + w.T[1], w.inGreen[1], w.cycle, in1);
+                if (bound(w, 2, out1, in1) <= bestScore.load() + 1e-12) continue;
+                offsets[1] = o;
+                search(w, 2, out1, in1, offsets);
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < max(1, threads); t++) pool.emplace_back(worker);
+        worker();
+        for (auto &th : pool) th.join();
+        return best;
+    }
+};
+
+// Synthetic arterial: East = outbound, West = inbound, plus two side
+// streets; arterial queues are heavier, links 15-45 s apart.
+vector<CorridorJunction> buildSyntheticCorridor(int junctions, unsigned seed = 11) {
+    mt19937 rng(seed);
+    vector<CorridorJunction> corridor(junctions);
+    for (int j = 0; j < junctions; j++) {
+        auto &cj = corridor[j];
+        cj.name = "J" + to_string(j + 1);
+        cj.travel = j == 0 ? 0 : 15 + rng() % 31;
+        cj.lanes = {{"East", 30 + (int)(rng() % 31), 0.0, 0.0},
+                    {"North", 5 + (int)(rng() % 26), 0.0, 0.0},
+                    {"West", 25 + (int)(rng() % 31), 0.0, 0.0},
+                    {"South", 5 + (int)(rng() % 26), 0.0, 0.0}};
+        cj.outLane = 0;
+        cj.inLane = 2;
+    }
+    return corridor;
+}
+
 // ---------- CSV Loader (lanes.csv: lane,queue) ---------- //
 
 bool loadLanesCSV(const string &filename, vector<Lane> &lanes) {
@@ -213,6 +1092,67 @@ bool loadLanesCSV(const string &filename, vector<Lane> &lanes) {
     return true;
 }
 
+// city.csv: junction,lane,queue,rate (rows of a junction kept together)
+bool loadCityCSV(const string &filename, JunctionNetwork &net) {
+    ifstream fin(filename);
+    if (!fin.is_open()) return false;
+
+    string line, lastJunction;
+    if (!getline(fin, line)) return false; // header
+
+    while (getline(fin, line)) {
+        stringstream ss(line);
+        string junction, lane, queueStr, rateStr;
+        getline(ss, junction, ',');
+        getline(ss, lane, ',');
+        getline(ss, queueStr, ',');
+        getline(ss, rateStr, ',');
+        if (junction.empty() || lane.empty()) continue;
+
+        if (junction != lastJunction) net.closeJunction();
+        lastJunction = junction;
+        try {
+            net.addLane(lane, stoi(queueStr), rateStr.empty() ? 0.0 : stod(rateStr));
+        } catch (...) {
+            net.addLane(lane, 0, 0.0);
+        }
+    }
+    net.closeJunction();
+    return net.junctions() > 0;
+}
+
+// corridor.csv: junction,travel,lane,queue,direction (out / in / blank),
+// junctions in order along the arterial, travel = seconds from the previous
+bool loadCorridorCSV(const string &filename, vector<CorridorJunction> &corridor) {
+    ifstream fin(filename);
+    if (!fin.is_open()) return false;
+
+    string line;
+    if (!getline(fin, line)) return false; // header
+
+    while (getline(fin, line)) {
+        stringstream ss(line);
+        string junction, travelStr, lane, queueStr, direction;
+        getline(ss, junction, ',');
+        getline(ss, travelStr, ',');
+        getline(ss, lane, ',');
+        getline(ss, queueStr, ',');
+        getline(ss, direction, ',');
+        if (junction.empty() || lane.empty()) continue;
+
+        if (corridor.empty() || corridor.back().name != junction) {
+            corridor.push_back({});
+            corridor.back().name = junction;
+            corridor.back().travel = corridor.size() == 1 ? 0 : atof(travelStr.c_str());
+        }
+        auto &cj = corridor.back();
+        if (direction == "out") cj.outLane = cj.lanes.size();
+        if (direction == "in") cj.inLane = cj.lanes.size();
+        cj.lanes.push_back({lane, max(0, atoi(queueStr.c_str())), 0.0, 0.0});
+    }
+    return !corridor.empty();
+}
+
 // ---------- Sample Data ---------- //
 
 vector<Lane> buildSampleLanes() {
@@ -252,12 +1192,210 @@ vector<Lane> buildCustomLanesInteractive() {
     return lanes;
 }
 
+// ---------- Benchmark: chunked heap vs water-filling ---------- //
+// Lanes start from the 20% equal base only, so the whole remaining cycle
+// goes through the allocator under test. Queues grow with the cycle length.
+// Junctions whose whole queue fits in the cycle ("drained") are left out
+// of the lane difference: there the heap's leftover split depends only on
+// the order it pops tied lanes.
+
+void runWaterFillBenchmark(int junctions) {
+    cout.setf(ios::fixed);
+    cout << setprecision(3);
+    cout << "\n=== Green allocation benchmark (" << junctions << " junctions each) ===\n\n";
+    cout << left << setw(8) << "Lanes" << setw(8) << "Cycle"
+         << setw(16) << "Heap (us)" << setw(20) << "Water-fill (us)"
+         << setw(20) << "Max lane diff (s)" << "Drained\n";
+    cout << string(70, '-') << "\n";
+
+    mt19937 rng(42);
+    for (int n : {4, 20, 200}) {
+        for (int cycleTime : {60, 120, 600, 1800}) {
+            vector<vector<Lane>> base(junctions);
+            for (auto &lanes : base) {
+                lanes.resize(n);
+                for (int i = 0; i < n; i++) {
+                    lanes[i].name = "L" + to_string(i);
+                    lanes[i].queueLength = 1 + rng() % (cycleTime / 2);
+                    lanes[i].baseGreen = lanes[i].allocatedGreen = 0.2 * cycleTime / n;
+                }
+            }
+
+            auto timeIt = [&](auto allocate, vector<vector<Lane>> &out) {
+                out = base;
+                auto start = chrono::steady_clock::now();
+                for (auto &lanes : out) allocate(lanes, cycleTime);
+                return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count()
+                       / junctions;
+            };
+            vector<vector<Lane>> heapPlans, fillPlans;
+            double heapUs = timeIt(adjustUsingPriorityQueue, heapPlans);
+            double fillUs = timeIt([](vector<Lane> &l, int c) { allocateWaterFilling(l, c); },
+                                   fillPlans);
+
+            double maxDiff = 0;
+            int drained = 0;
+            for (int j = 0; j < junctions; j++) {
+                double demand = 0;
+                for (auto &ln : base[j]) demand += 2.0 * ln.queueLength;
+                if (demand <= 0.8 * cycleTime) { drained++; continue; }
+                for (int i = 0; i < n; i++)
+                    maxDiff = max(maxDiff, fabs(heapPlans[j][i].allocatedGreen -
+                                                fillPlans[j][i].allocatedGreen));
+            }
+
+            cout << left << setw(8) << n << setw(8) << cycleTime
+                 << setw(16) << heapUs << setw(20) << fillUs
+                 << setw(20) << maxDiff << drained << "\n";
+        }
+    }
+}
+
 // ---------- MAIN ---------- //
+// Usage: P3 [waterfill-bench [junctions]
+//           | city-sim [junctions|city.csv] [hours] [cycle] [threads] [discharge]
+//           | montecarlo [replications] [cycles] [poisson|platoon] [cycle] [load]
+//           | stream [feed.csv|-] [cycle] [budget-us]
+//           | corridor [junctions|corridor.csv] [threads] [step] [min-cycle] [max-cycle]]
 
-int main() {
+int main(int argc, char *argv[]) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "city-sim") {
+        string source = argc > 2 ? argv[2] : "5000";
+        int hours = argc > 3 ? max(1, atoi(argv[3])) : 24;
+        int cycleTime = argc > 4 ? max(10, atoi(argv[4])) : 120;
+        int threads = argc > 5 ? max(1, atoi(argv[5]))
+                               : (int)max(1u, thread::hardware_concurrency());
+        double discharge = argc > 6 ? atof(argv[6]) : 0.5;
+
+        JunctionNetwork net;
+        if (all_of(source.begin(), source.end(), ::isdigit)) {
+            net = buildSyntheticNetwork(max(1, atoi(source.c_str())));
+        } else if (!loadCityCSV(source, net)) {
+            cout << source << " not found or invalid.\n";
+            return 0;
+        }
+
+        auto start = chrono::steady_clock::now();
+        vector<HourStats> stats = simulateNetwork(net, cycleTime, discharge, hours, threads);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printNetworkReport(net, stats, cycleTime, threads, seconds);
+        return 0;
+    }
+
+    if (mode == "corridor") {
+        string source = argc > 2 ? argv[2] : "50";
+        int threads = argc > 3 ? max(1, atoi(argv[3]))
+                               : (int)max(1u, thread::hardware_concurrency());
+        double step = argc > 4 ? atof(argv[4]) : 2.0;
+        int cycleMin = argc > 5 ? max(20, atoi(argv[5])) : 60;
+        int cycleMax = argc > 6 ? max(cycleMin, atoi(argv[6])) : 150;
+
+        vector<CorridorJunction> corridor;
+        if (all_of(source.begin(), source.end(), ::isdigit)) {
+            corridor = buildSyntheticCorridor(max(1, atoi(source.c_str())));
+        } else if (!loadCorridorCSV(source, corridor)) {
+            cout << source << " not found or invalid.\n";
+            return 0;
+        }
+
+        auto start = chrono::steady_clock::now();
+        CorridorOptimizer opt(corridor, step);
+        CorridorPlan plan = opt.optimize(cycleMin, cycleMax, 10, threads);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout.setf(ios::fixed);
+        cout << setprecision(1);
+        cout << "\n=== Corridor plan: " << corridor.size() << " junctions, cycle "
+             << plan.cycle << " s ===\n\n";
+        cout << left << setw(16) << "Junction" << setw(12) << "Travel (s)"
+             << "Offset (s)\n";
+        cout << string(40, '-') << "\n";
+        for (size_t j = 0; j < corridor.size(); j++)
+            cout << left << setw(16) << corridor[j].name << setw(12) << corridor[j].travel
+                 << plan.offsets[j] << "\n";
+        cout << "\nOutbound band: " << plan.outBand << " s  Inbound band: " << plan.inBand
+             << " s  Efficiency: " << setprecision(3) << plan.efficiency << "\n";
+        cout << "Search: cycles " << cycleMin << "-" << cycleMax << " step 10, offsets step "
+             << step << " s, " << opt.nodesExplored() << " nodes, " << threads
+             << " threads, " << setprecision(2) << sec << " s\n";
+        return 0;
+    }
+
+    if (mode == "stream") {
+        string feed = argc > 2 ? argv[2] : "-";
+        int cycleTime = argc > 3 ? max(10, atoi(argv[3])) : 120;
+        double budgetUs = argc > 4 ? atof(argv[4]) : 1000.0;
+
+        vector<Lane> lanes;
+        if (!loadLanesCSV("lanes.csv", lanes)) lanes = buildSampleLanes();
+
+        if (feed == "-") {
+            runStreamingController(cin, false, lanes, cycleTime, budgetUs);
+        } else {
+            ifstream fin(feed);
+            if (!fin.is_open()) {
+                cout << feed << " not found.\n";
+                return 0;
+            }
+            runStreamingController(fin, true, lanes, cycleTime, budgetUs);
+        }
+        return 0;
+    }
+
+    if (mode == "montecarlo") {
+        int replications = argc > 2 ? max(1, atoi(argv[2])) : 4096;
+        int cycles = argc > 3 ? max(1, atoi(argv[3])) : 720;
+        int platoon = (argc > 4 && string(argv[4]) == "platoon") ? 4 : 1;
+        int cycleTime = argc > 5 ? max(10, atoi(argv[5])) : 120;
+        double load = argc > 6 ? atof(argv[6]) : 0.9;
+        const int discharge = 1;
+
+        vector<Lane> lanes;
+        if (!loadLanesCSV("lanes.csv", lanes) || lanes.empty()) lanes = buildSampleLanes();
+
+        // Queues in lanes.csv give each lane's share of demand; `load` is
+        // total arrivals per cycle as a fraction of what the cycle can serve.
+        long long totalQueue = 0;
+        for (auto &ln : lanes) totalQueue += ln.queueLength;
+        vector<double> arrivalsPerCycle;
+        for (auto &ln : lanes)
+            arrivalsPerCycle.push_back(totalQueue == 0 ? 0.0
+                : load * cycleTime * discharge * ln.queueLength / totalQueue);
+
+        // The two strategies on their own: proportional split of the whole
+        // cycle, and the priority heap handing out everything above the base.
+        vector<Lane> proportionalPlan = lanes;
+        allocateGreenProportional(proportionalPlan, cycleTime);
+        adjustUsingPriorityQueue(proportionalPlan, cycleTime);
+
+        vector<Lane> priorityPlan = lanes;
+        for (auto &ln : priorityPlan) ln.baseGreen = ln.allocatedGreen = 0.2 * cycleTime / lanes.size();
+        adjustUsingPriorityQueue(priorityPlan, cycleTime);
+
+        string arrivalsName = platoon > 1 ? "platoon arrivals" : "Poisson arrivals";
+        for (auto &[title, plan] : vector<pair<string, vector<Lane> *>>{
+                 {"Proportional allocation", &proportionalPlan},
+                 {"Base + priority heap", &priorityPlan}}) {
+            MonteCarloResult res = evaluatePlanMonteCarlo(*plan, arrivalsPerCycle, cycleTime,
+                                                          discharge, replications, cycles,
+                                                          platoon, 12345);
+            printMonteCarloReport(title + ", " + arrivalsName + ", " + to_string(replications)
+                                  + " x " + to_string(cycles) + " cycles",
+                                  *plan, arrivalsPerCycle, res);
+        }
+        return 0;
+    }
+
+    if (mode == "waterfill-bench") {
+        runWaterFillBenchmark(argc > 2 ? max(1, atoi(argv[2])) : 2000);
+        return 0;
+    }
+
     cout << "Problem 3 – Traffic Signal Timing Optimization (CSV-enabled)\n\n";
 
     vector<Lane> lanes;
@@ -7,18 +7,73 @@ class CityGraph {
 public:
     int n;
     vector<vector<int>> adj;
+    vector<vector<int>> adjEdge;    // adjEdge[u][i] = id of the road adj[u][i]
+    vector<pair<int,int>> edges;    // endpoints by road id
 
     CityGraph(int nodes = 0) { init(nodes); }
 
     void init(int nodes) {
         n = nodes;
         adj.assign(n, {});
+        adjEdge.assign(n, {});
+        edges.clear();
+        byEnds.clear();
+        sameEnds.clear();
     }
 
-    void addEdge(int u, int v) {
-        if (u < 0 || v < 0 || u >= n || v >= n) return;
+    int addEdge(int u, int v) {
+        if (u < 0 || v < 0 || u >= n || v >= n) return -1;
+        int id = edges.size();
+        edges.push_back({u, v});
         adj[u].push_back(v);
+        adjEdge[u].push_back(id);
         adj[v].push_back(u);
+        adjEdge[v].push_back(id);
+
+        auto it = byEnds.find(key(u, v));
+        sameEnds.push_back(it == byEnds.end() ? -1 : it->second);
+        byEnds[key(u, v)] = id;
+        return id;
+    }
+
+    // Ids of every road between u and v (parallel roads included).
+    template <class F>
+    void forEachEdgeBetween(int u, int v, F f) const {
+        auto it = byEnds.find(key(u, v));
+        for (int id = it == byEnds.end() ? -1 : it->second; id != -1; id = sameEnds[id])
+            f(id);
+    }
+
+private:
+    unordered_map<long long, int> byEnds; // newest road id per endpoint pair
+    vector<int> sameEnds;                 // previous road id with the same endpoints
+
+    static long long key(int u, int v) {
+        if (u > v) swap(u, v);
+        return (long long)u << 32 | (unsigned)v;
+    }
+};
+
+// ---------------- Closure Overlay ---------------- //
+// One bit per road id over a shared, never-modified CityGraph: closing or
+// reopening a road is a single bit flip, and any number of overlays
+// (closure sets) can be held against the same graph.
+
+class ClosureMask {
+    vector<uint64_t> bits; // 1 = closed
+
+public:
+    ClosureMask(const CityGraph &g) : bits((g.edges.size() + 63) / 64, 0) {}
+
+    void close(int id) { bits[id >> 6] |= 1ULL << (id & 63); }
+    void open(int id) { bits[id >> 6] &= ~(1ULL << (id & 63)); }
+    bool isOpen(int id) const { return !(bits[id >> 6] >> (id & 63) & 1); }
+
+    void closeRoad(const CityGraph &g, int u, int v) {
+        g.forEachEdgeBetween(u, v, [&](int id) { close(id); });
+    }
+    void openRoad(const CityGraph &g, int u, int v) {
+        g.forEachEdgeBetween(u, v, [&](int id) { open(id); });
     }
 };
 
@@ -30,10 +85,20 @@ void dfs(int u, vector<int> &vis, const vector<vector<int>> &adj) {
         if (!vis[v]) dfs(v, vis, adj);
 }
 
+// Same walk, skipping roads closed in the overlay.
+void dfs(int u, vector<int> &vis, const CityGraph &g, const ClosureMask &closures) {
+    vis[u] = 1;
+    for (size_t i = 0; i < g.adj[u].size(); i++) {
+        int v = g.adj[u][i];
+        if (!vis[v] && closures.isOpen(g.adjEdge[u][i])) dfs(v, vis, g, closures);
+    }
+}
+
 // ---------------- BFS Shortest Path ---------------- //
 
 void bfsPath(int src, const CityGraph &g,
-             vector<int> &dist, vector<int> &parent) {
+             vector<int> &dist, vector<int> &parent,
+             const ClosureMask *closures = nullptr) {
 
     dist.assign(g.n, INF);
     parent.assign(g.n, -1);
@@ -44,7 +109,9 @@ void bfsPath(int src, const CityGraph &g,
 
     while (!q.empty()) {
         int u = q.front(); q.pop();
-        for (int v : g.adj[u]) {
+        for (size_t i = 0; i < g.adj[u].size(); i++) {
+            int v = g.adj[u][i];
+            if (closures && !closures->isOpen(g.adjEdge[u][i])) continue;
             if (dist[v] == INF) {
                 dist[v] = dist[u] + 1;
                 parent[v] = u;
@@ -54,6 +121,121 @@ void bfsPath(int src, const CityGraph &g,
     }
 }
 
+// ---------------- Bit-Parallel BFS (64 closure scenarios) ---------------- //
+// Scenario s lives in bit s of every word: edgeOpen[id] says in which
+// scenarios road id is open, reached[v] in which scenarios v has been
+// reached. A level moves frontier[u] & edgeOpen[id] across each road, so one
+// sweep does the work of up to 64 separate BFS runs. Only vertices with a
+// non-empty frontier word are expanded. Returns the hop distance from src
+// to target per scenario (INF where target is cut off).
+
+vector<int> bfsBitParallel(int src, int target, const CityGraph &g,
+                           const vector<uint64_t> &edgeOpen,
+                           vector<uint64_t> &reached, uint64_t scenarios = ~0ULL) {
+    vector<int> targetDist(64, INF);
+    reached.assign(g.n, 0);
+    vector<uint64_t> frontier(g.n, 0), next(g.n, 0);
+    vector<int> active = {src}, nextActive;
+
+    reached[src] = frontier[src] = scenarios;
+    if (src == target)
+        for (int s = 0; s < 64; s++)
+            if (scenarios >> s & 1) targetDist[s] = 0;
+
+    for (int level = 1; !active.empty(); level++) {
+        nextActive.clear();
+        for (int u : active) {
+            uint64_t f = frontier[u];
+            for (size_t i = 0; i < g.adj[u].size(); i++) {
+                int v = g.adj[u][i];
+                uint64_t m = f & edgeOpen[g.adjEdge[u][i]] & ~reached[v];
+                if (!m) continue;
+                if (!next[v]) nextActive.push_back(v);
+                next[v] |= m;
+            }
+            frontier[u] = 0;
+        }
+        for (int v : nextActive) {
+            reached[v] |= next[v];
+            if (v == target)
+                for (uint64_t m = next[v]; m; m &= m - 1)
+                    targetDist[__builtin_ctzll(m)] = level;
+            frontier[v] = next[v];
+            next[v] = 0;
+        }
+        active.swap(nextActive);
+    }
+    return targetDist;
+}
+
+struct ScenarioResult {
+    int reachable;  // locations reachable from the station
+    int hops;       // hop distance to the incident, INF if isolated
+};
+
+// Any number of closure sets (road ids closed in each), 64 per sweep.
+vector<ScenarioResult> evaluateScenarios(const CityGraph &g, int station, int incident,
+                                         const vector<vector<int>> &closedRoads) {
+    vector<ScenarioResult> results(closedRoads.size());
+    vector<uint64_t> edgeOpen, reached;
+    for (size_t base = 0; base < closedRoads.size(); base += 64) {
+        int count = min<size_t>(64, closedRoads.size() - base);
+        uint64_t scenarios = count == 64 ? ~0ULL : (1ULL << count) - 1;
+        edgeOpen.assign(g.edges.size(), scenarios);
+        for (int s = 0; s < count; s++)
+            for (int id : closedRoads[base + s])
+                edgeOpen[id] &= ~(1ULL << s);
+
+        vector<int> hops = bfsBitParallel(station, incident, g, edgeOpen, reached, scenarios);
+        vector<int> reachable(count, 0);
+        for (uint64_t r : reached)
+            for (uint64_t m = r; m; m &= m - 1) reachable[__builtin_ctzll(m)]++;
+        for (int s = 0; s < count; s++) results[base + s] = {reachable[s], hops[s]};
+    }
+    return results;
+}
+
+// Grid city with random closure sets: bit-parallel sweeps against one
+// masked BFS per scenario, checking that both agree.
+void runScenarioBenchmark(int side, int scenarioCount) {
+    CityGraph g(side * side);
+    for (int r = 0; r < side; r++)
+        for (int c = 0; c < side; c++) {
+            if (c + 1 < side) g.addEdge(r * side + c, r * side + c + 1);
+            if (r + 1 < side) g.addEdge(r * side + c, (r + 1) * side + c);
+        }
+
+    mt19937 rng(17);
+    vector<vector<int>> closed(scenarioCount);
+    for (auto &set : closed) {
+        int k = g.edges.size() / 10;
+        for (int i = 0; i < k; i++) set.push_back(rng() % g.edges.size());
+    }
+    int station = 0, incident = g.n - 1;
+
+    auto start = chrono::steady_clock::now();
+    vector<ScenarioResult> fast = evaluateScenarios(g, station, incident, closed);
+    double fastMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    int mismatches = 0;
+    vector<int> dist, parent;
+    for (int s = 0; s < scenarioCount; s++) {
+        ClosureMask closures(g);
+        for (int id : closed[s]) closures.close(id);
+        bfsPath(station, g, dist, parent, &closures);
+        int reachable = count_if(dist.begin(), dist.end(), [](int d) { return d != INF; });
+        if (reachable != fast[s].reachable || dist[incident] != fast[s].hops) mismatches++;
+    }
+    double slowMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    cout << "Grid " << side << "x" << side << ", " << scenarioCount
+         << " scenarios (10% of roads closed each)\n";
+    cout << "Bit-parallel: " << fastMs << " ms   One BFS per scenario: " << slowMs
+         << " ms   Speedup: " << slowMs / max(fastMs, 1e-9) << "x   Mismatches: "
+         << mismatches << "\n";
+}
+
 // ---------------- Reconstruct Path ---------------- //
 
 vector<int> reconstruct(int dest, const vector<int> &parent) {
@@ -131,6 +313,55 @@ bool loadBlockedCSV(string file, vector<pair<int,int>> &blocked) {
     return true;
 }
 
+// scenarios.csv: scenario,u,v — one row per closed road; a row with no
+// road declares a scenario with nothing closed. Scenarios keep file order.
+bool loadScenariosCSV(string file, const CityGraph &g,
+                      vector<string> &labels, vector<vector<int>> &closedRoads) {
+    ifstream fin(file);
+    if (!fin.is_open()) return false;
+
+    labels.clear();
+    closedRoads.clear();
+    unordered_map<string, int> index;
+    string line;
+    getline(fin, line); // skip header
+    int lineNo = 1;
+
+    while (getline(fin, line)) {
+        lineNo++;
+        stringstream ss(line);
+        string label, uStr, vStr;
+        getline(ss, label, ',');
+        getline(ss, uStr, ',');
+        getline(ss, vStr, ',');
+        if (label.empty()) continue;
+
+        auto it = index.find(label);
+        if (it == index.end()) {
+            it = index.emplace(label, labels.size()).first;
+            labels.push_back(label);
+            closedRoads.push_back({});
+        }
+        if (uStr.empty() || vStr.empty()) continue;
+
+        // A row that names no road would silently leave its scenario open,
+        // so bad numbers and unknown roads are reported and skipped.
+        char *endU = nullptr, *endV = nullptr;
+        long u = strtol(uStr.c_str(), &endU, 10), v = strtol(vStr.c_str(), &endV, 10);
+        if (*endU != '\0' || *endV != '\0' || u < 0 || v < 0 || u >= g.n || v >= g.n) {
+            cerr << "Warning: " << file << " line " << lineNo << ": bad road \"" << uStr
+                 << "," << vStr << "\", row skipped\n";
+            continue;
+        }
+        size_t before = closedRoads[it->second].size();
+        g.forEachEdgeBetween(u, v, [&](int id) { closedRoads[it->second].push_back(id); });
+        if (closedRoads[it->second].size() == before)
+            cerr << "Warning: " << file << " line " << lineNo << ": no road " << u << " -- "
+                 << v << ", scenario " << label << " closes nothing for it\n";
+    }
+    return true;
+}
+
 // ---------------- Build Sample (Fallback) ---------------- //
 
 void buildSample(CityGraph &g, vector<pair<int,int>> &blocked, vector<string> &names) {
@@ -153,12 +384,21 @@ void buildSample(CityGraph &g, vector<pair<int,int>> &blocked, vector<string> &n
 }
 
 // ---------------- MAIN ---------------- //
+// Usage: P4 [scenarios [file] [station] [incident] | scenario-bench [side] [count]]
 
-int main() {
+int main(int argc, char *argv[]) {
 
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "scenario-bench") {
+        runScenarioBenchmark(argc > 2 ? max(2, atoi(argv[2])) : 300,
+                             argc > 3 ? max(1, atoi(argv[3])) : 640);
+        return 0;
+    }
+
     cout << "Problem 4 – Emergency Fastest Route Planner (CSV Enabled)\n\n";
 
     vector<string> names;
@@ -182,6 +422,39 @@ int main() {
         buildSample(graph, blocked, names);
     }
 
+    if (mode == "scenarios") {
+        string file = argc > 2 ? argv[2] : "scenarios.csv";
+        int station = argc > 3 ? atoi(argv[3]) : 0;
+        int incident = argc > 4 ? atoi(argv[4]) : graph.n - 1;
+        if (station < 0 || station >= graph.n || incident < 0 || incident >= graph.n) {
+            cout << "Invalid station or incident index.\n";
+            return 0;
+        }
+
+        vector<string> labels;
+        vector<vector<int>> closedRoads;
+        if (!loadScenariosCSV(file, graph, labels, closedRoads)) {
+            cout << file << " not found.\n";
+            return 0;
+        }
+
+        auto start = chrono::steady_clock::now();
+        auto results = evaluateScenarios(graph, station, incident, closedRoads);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        cout << "\nStation: " << names[station] << "   Incident: " << names[incident] << "\n\n";
+        cout << left << setw(24) << "Scenario" << setw(14) << "Reachable" << "Hops to incident\n";
+        cout << string(56, '-') << "\n";
+        for (size_t s = 0; s < results.size(); s++) {
+            cout << left << setw(24) << labels[s] << setw(14) << results[s].reachable;
+            if (results[s].hops == INF) cout << "isolated\n";
+            else cout << results[s].hops << "\n";
+        }
+        cout << "\n" << results.size() << " scenarios in " << (results.size() + 63) / 64
+             << " bit-parallel sweep(s), " << ms << " ms\n";
+        return 0;
+    }
+
     cout << "\nLocations:\n";
     for (int i = 0; i < names.size(); i++)
         cout << i << " → " << names[i] << "\n";
@@ -192,17 +465,14 @@ int main() {
     cout << "Enter accident/incident index: ";
     cin >> incident;
 
-    // Apply blocked roads
-    for (auto &b : blocked) {
-        int u = b.first, v = b.second;
-
-        graph.adj[u].erase(remove(graph.adj[u].begin(), graph.adj[u].end(), v), graph.adj[u].end());
-        graph.adj[v].erase(remove(graph.adj[v].begin(), graph.adj[v].end(), u), graph.adj[v].end());
-    }
+    // Apply blocked roads (overlay; the graph itself stays intact)
+    ClosureMask closures(graph);
+    for (auto &b : blocked)
+        closures.closeRoad(graph, b.first, b.second);
 
     // Reachability check
     vector<int> vis(graph.n, 0);
-    dfs(station, vis, graph.adj);
+    dfs(station, vis, graph, closures);
 
     if (!vis[incident]) {
         cout << "\n❌ NO ROUTE POSSIBLE — Blocked roads isolate the incident!\n";
@@ -210,7 +480,7 @@ int main() {
     }
 
     vector<int> dist, parent;
-    bfsPath(station, graph, dist, parent);
+    bfsPath(station, graph, dist, parent, &closures);
 
     cout << "\nShortest hop-count distance = " << dist[incident] << "\n";
     cout << "Emergency Route:\n";